@@ -16,10 +16,17 @@ struct Fog {
     bool enable;
 };
 
-uniform vec3 objectColor;
-uniform vec3 viewPos;
+// Per view, written once by MasterRenderer (FrameUniforms, binding 0)
+layout (std140) uniform FrameData {
+    mat4 view;
+    mat4 projection;
+    vec3 viewPos;
+    float bloomThreshold;
+    vec3 lightPosition;
+    vec3 lightColor;
+};
 
-uniform float bloomThreshold;
+uniform vec3 objectColor;
 
 uniform Fog fog;
 
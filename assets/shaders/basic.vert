@@ -6,9 +6,17 @@ out VS_OUT {
     vec3 FragPos;
 } vs_out;
 
+// Per view, written once by MasterRenderer (FrameUniforms, binding 0)
+layout (std140) uniform FrameData {
+    mat4 view;
+    mat4 projection;
+    vec3 viewPos;
+    float bloomThreshold;
+    vec3 lightPosition;
+    vec3 lightColor;
+};
+
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
 
 void main() {
     vs_out.FragPos = vec3(model * vec4(position, 1.0f));
@@ -0,0 +1,58 @@
+#version 330 core
+
+out vec4 FragColor;
+
+in vec2 TexCoords;
+
+// Mip-chain bloom, one pass per level of the chain.
+// Without UPSAMPLE: 13-tap downsample of the next larger level (the target is half of the source).
+// UPSAMPLE: 3x3 tent filter of the next smaller level, added onto the target by the blending.
+uniform sampler2D source;
+// The level covers the lower left part of its texture (RenderTargetPool), in texture coordinates
+uniform vec2 region;
+uniform float filterRadius;
+
+vec2 texel;
+
+// Clamped to the level like GL_CLAMP_TO_EDGE, the texels past it are not part of the level.
+vec3 Sample(vec2 uv) {
+    return texture(source, min(uv, region - 0.5f * texel)).rgb;
+}
+
+void main() {
+    texel = 1.0f / textureSize(source, 0);
+    vec2 uv = TexCoords * region;
+
+#ifdef UPSAMPLE
+    vec2 d = texel * filterRadius;
+    vec3 result = Sample(uv) * 4.0f;
+    result += (Sample(uv + vec2(-d.x, 0.0f)) + Sample(uv + vec2(d.x, 0.0f))
+             + Sample(uv + vec2(0.0f, -d.y)) + Sample(uv + vec2(0.0f, d.y))) * 2.0f;
+    result += Sample(uv + vec2(-d.x, -d.y)) + Sample(uv + vec2(d.x, -d.y))
+            + Sample(uv + vec2(-d.x, d.y)) + Sample(uv + vec2(d.x, d.y));
+    result /= 16.0f;
+#else
+    // 外圈 3x3 個點間隔兩個 texel，內圈 4 個點落在 texel 的角上，線性過濾讓每一點都是 2x2 的平均
+    vec3 a = Sample(uv + texel * vec2(-2.0f,  2.0f));
+    vec3 b = Sample(uv + texel * vec2( 0.0f,  2.0f));
+    vec3 c = Sample(uv + texel * vec2( 2.0f,  2.0f));
+    vec3 d = Sample(uv + texel * vec2(-2.0f,  0.0f));
+    vec3 e = Sample(uv);
+    vec3 f = Sample(uv + texel * vec2( 2.0f,  0.0f));
+    vec3 g = Sample(uv + texel * vec2(-2.0f, -2.0f));
+    vec3 h = Sample(uv + texel * vec2( 0.0f, -2.0f));
+    vec3 i = Sample(uv + texel * vec2( 2.0f, -2.0f));
+    vec3 j = Sample(uv + texel * vec2(-1.0f,  1.0f));
+    vec3 k = Sample(uv + texel * vec2( 1.0f,  1.0f));
+    vec3 l = Sample(uv + texel * vec2(-1.0f, -1.0f));
+    vec3 m = Sample(uv + texel * vec2( 1.0f, -1.0f));
+
+    // The weights sum up to 1, the energy of the level is kept.
+    vec3 result = e * 0.125f;
+    result += (a + c + g + i) * 0.03125f;
+    result += (b + d + f + h) * 0.0625f;
+    result += (j + k + l + m) * 0.125f;
+#endif
+
+    FragColor = vec4(result, 1.0f);
+}
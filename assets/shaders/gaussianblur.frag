@@ -5,22 +5,32 @@ out vec4 FragColor;
 in vec2 TexCoords;
 
 uniform sampler2D image;
+// The image covers the lower left part of its texture (RenderTargetPool), in texture coordinates
+uniform vec2 region;
 uniform bool isHorizontal;
 uniform float weight[5] = float[] (0.227027, 0.1945946, 0.1216216, 0.054054, 0.016216);
 
+vec2 texture_offset;
+
+// Clamped to the image like GL_CLAMP_TO_EDGE, the texels past it are not part of the image.
+vec3 Sample(vec2 uv) {
+    return texture(image, min(uv, region - 0.5f * texture_offset)).rgb;
+}
+
 void main() {
     // 用於計算高斯模糊
-    vec2 texture_offset = 1.0f / textureSize(image, 0);
-    vec3 result = texture(image, TexCoords).rgb * weight[0];
+    texture_offset = 1.0f / textureSize(image, 0);
+    vec2 uv = TexCoords * region;
+    vec3 result = Sample(uv) * weight[0];
     if (isHorizontal) {
         for (int i = 1; i < 5; i++) {
-            result += texture(image, TexCoords + vec2(texture_offset.x * i, 0.0)).rgb * weight[i];
-            result += texture(image, TexCoords - vec2(texture_offset.x * i, 0.0)).rgb * weight[i];
+            result += Sample(uv + vec2(texture_offset.x * i, 0.0)) * weight[i];
+            result += Sample(uv - vec2(texture_offset.x * i, 0.0)) * weight[i];
         }
     } else {
         for (int i = 1; i < 5; i++) {
-            result += texture(image, TexCoords + vec2(0.0, texture_offset.y * i)).rgb * weight[i];
-            result += texture(image, TexCoords - vec2(0.0, texture_offset.y * i)).rgb * weight[i];
+            result += Sample(uv + vec2(0.0, texture_offset.y * i)) * weight[i];
+            result += Sample(uv - vec2(0.0, texture_offset.y * i)) * weight[i];
         }
     }
 
@@ -3,18 +3,24 @@ out vec4 FragColor;
 
 in vec2 TexCoords;
 
-uniform sampler2D screenTexture;
-uniform int screenMode;
+// Permutations, defined by ScreenRenderer from the settings of World:
+// SCREEN_MODE (PostEffect), USE_BLOOM, USE_HDR, HDR_MODE (HDRMode), USE_GAMMA
+#ifndef SCREEN_MODE
+#define SCREEN_MODE 0
+#endif
+#ifndef HDR_MODE
+#define HDR_MODE 0
+#endif
 
-uniform bool useBloom;
+uniform sampler2D screenTexture;
 uniform sampler2D bloomTexture;
+// Both textures are drawn into their lower left part only (RenderTargetPool), the parts in texture coordinates
+uniform vec2 screenRegion;
+uniform vec2 bloomRegion;
 uniform float bloomIntensity;
 
-uniform bool useGamma;
 uniform float gammaValue;
 
-uniform bool useHDR;
-uniform int hdrMode;
 uniform float hdrExposure;
 
 const float offset = 1.0f / 300.0f;
@@ -33,9 +39,12 @@ vec4 CalcKernel(float kernel[9]) {
         vec2(offset, -offset)
     );
 
+    // Clamped to the drawn part like GL_CLAMP_TO_EDGE
+    vec2 uv = TexCoords.st * screenRegion;
+    vec2 uv_max = screenRegion - 0.5f / textureSize(screenTexture, 0);
     vec3 sampleTex[9];
     for (int i = 0; i < 9; i++) {
-        sampleTex[i] = vec3(texture(screenTexture, TexCoords.st + offsets[i]));
+        sampleTex[i] = vec3(texture(screenTexture, min(uv + offsets[i], uv_max)));
     }
 
     vec3 temp_color = vec3(0.0f);
@@ -49,67 +58,61 @@ vec4 CalcKernel(float kernel[9]) {
 
 void main() {
 
-    vec4 main_color = texture(screenTexture, TexCoords);
-
-    if (useBloom) {
-        vec4 bloom_color = texture(bloomTexture, TexCoords);
-        main_color += bloom_color * bloomIntensity;
-    }
-
-    switch (screenMode) {
-        case 1:
-            // 顏色相反，
-            main_color = vec4(vec3(1.0 - main_color.rgb), 1.0f);
-            break;
-        case 2:
-            // 灰階度，人眼對於綠色更加敏感，這樣計算會更加有物理精準效果（配上權重）。
-            float average = 0.2126f * main_color.r + 0.7152 * main_color.g + 0.0722 * main_color.b;
-            main_color = vec4(average, average, average, 1.0f);
-            break;
-        case 3:
-            // 麻醉效果
-            float kernel_Narc[9] = float[](
-                -1, -1, -1,
-                -1,  9, -1,
-                -1, -1, -1
-            );
-            main_color = CalcKernel(kernel_Narc);
-            break;
-        case 4:
-            // 模糊效果
-            float kernel_blur[9] = float[](
-                1.0f / 16f, 2.0f / 16.0f, 1.0f / 16.0f,
-                2.0f / 16f, 4.0f / 16.0f, 2.0f / 16.0f,
-                1.0f / 16f, 2.0f / 16.0f, 1.0f / 16.0f
-            );
-            main_color = CalcKernel(kernel_blur);
-            break;
-        case 5:
-            // 邊緣偵測
-            float kernel_ED[9] = float[](
-                1, 1, 1,
-                1, -8, 1,
-                1, 1, 1
-            );
-            main_color = CalcKernel(kernel_ED);
-            break;
-    }
+    vec4 main_color = texture(screenTexture, TexCoords * screenRegion);
+
+#ifdef USE_BLOOM
+    vec4 bloom_color = texture(bloomTexture, TexCoords * bloomRegion);
+    main_color += bloom_color * bloomIntensity;
+#endif
+
+#if SCREEN_MODE == 1
+    // 顏色相反，
+    main_color = vec4(vec3(1.0 - main_color.rgb), 1.0f);
+#elif SCREEN_MODE == 2
+    // 灰階度，人眼對於綠色更加敏感，這樣計算會更加有物理精準效果（配上權重）。
+    float average = 0.2126f * main_color.r + 0.7152 * main_color.g + 0.0722 * main_color.b;
+    main_color = vec4(average, average, average, 1.0f);
+#elif SCREEN_MODE == 3
+    // 麻醉效果
+    float kernel_Narc[9] = float[](
+        -1, -1, -1,
+        -1,  9, -1,
+        -1, -1, -1
+    );
+    main_color = CalcKernel(kernel_Narc);
+#elif SCREEN_MODE == 4
+    // 模糊效果
+    float kernel_blur[9] = float[](
+        1.0f / 16f, 2.0f / 16.0f, 1.0f / 16.0f,
+        2.0f / 16f, 4.0f / 16.0f, 2.0f / 16.0f,
+        1.0f / 16f, 2.0f / 16.0f, 1.0f / 16.0f
+    );
+    main_color = CalcKernel(kernel_blur);
+#elif SCREEN_MODE == 5
+    // 邊緣偵測
+    float kernel_ED[9] = float[](
+        1, 1, 1,
+        1, -8, 1,
+        1, 1, 1
+    );
+    main_color = CalcKernel(kernel_ED);
+#endif
 
     vec3 hdr_color = main_color.rgb;
 
-    if (useHDR) {
-        if (hdrMode == 0) {
-            // Reinhard Color Mapping
-            hdr_color = hdr_color / (hdr_color + vec3(1.0f));
-        } else {
-            // Exposure
-            hdr_color = vec3(1.0f) - exp(-hdr_color * hdrExposure);
-        }
-    }
-
-    if (useGamma) {
-        hdr_color = pow(hdr_color, vec3(1.0 / gammaValue));
-    }
+#ifdef USE_HDR
+#if HDR_MODE == 0
+    // Reinhard Color Mapping
+    hdr_color = hdr_color / (hdr_color + vec3(1.0f));
+#else
+    // Exposure
+    hdr_color = vec3(1.0f) - exp(-hdr_color * hdrExposure);
+#endif
+#endif
+
+#ifdef USE_GAMMA
+    hdr_color = pow(hdr_color, vec3(1.0 / gammaValue));
+#endif
 
     FragColor = vec4(hdr_color, 1.0f);
 }
\ No newline at end of file
@@ -1,55 +1,119 @@
 #version 330 core
 layout (location = 0) out vec4 FragColor;
 layout (location = 1) out vec4 BrightColor;
+// (取樣數, 1) — 整張圖平均後相除就是每條射線的平均取樣數
+layout (location = 2) out vec4 RayStatistics;
 
 in VS_OUT {
     vec3 FragPos;
     vec3 TexCoord;
 } fs_in;
 
-struct Light {
-    vec3 position;
-    vec3 color;
+// Permutations, defined by VolumeRenderer from the settings of World:
+// VOLUME_LAYOUT, USE_LIGHTING, USE_NORMAL_COLOR, USE_EMPTY_SPACE_SKIPPING, USE_PREINTEGRATION,
+// USE_ADAPTIVE_SAMPLING, USE_OPACITY_CORRECTION, USE_LEGACY_RAY_SETUP
+#ifndef VOLUME_LAYOUT
+#define VOLUME_LAYOUT 0
+#endif
+#if defined(USE_EMPTY_SPACE_SKIPPING) || defined(USE_ADAPTIVE_SAMPLING)
+#define USE_BRICKS
+#endif
+
+// Per view, written once by MasterRenderer (FrameUniforms, binding 0)
+layout (std140) uniform FrameData {
+    mat4 view;
+    mat4 projection;
+    vec3 viewPos;
+    float bloomThreshold;
+    vec3 lightPosition;
+    vec3 lightColor;
+};
+
+// Per draw, written once by VolumeRenderer (VolumeUniforms, binding 1)
+layout (std140) uniform VolumeData {
+    mat4 model;
+    vec3 volume_resolution;
+    float sample_rate;
+    // 每個 voxel 的大小
+    vec3 volume_ratio;
+    // VOLUME_LAYOUT 0: RGBA32F (normal in rgb, value in a), 1: scalar + RGB8_SNORM normal, 2: scalar + RG16 octahedral normal
+    float value_scale;
+    // 攝影機在材質座標中的位置
+    vec3 camera_in_texture;
+    float brick_size;
+    vec3 background_color;
+    // The alpha of the transfer function is the opacity of a sample over this step length.
+    float reference_step;
+    float max_step_scale;
+    float importance_threshold;
+    float shininess;
 };
 
 uniform sampler3D volume;
+uniform sampler3D normal_volume;
 uniform sampler1D transfer_function;
-uniform vec3 volume_resolution;
-uniform vec3 volume_ratio;
-uniform float sample_rate;
-uniform vec3 background_color;
-
-uniform float shininess;
-uniform vec3 viewPos;
-uniform bool useLighting;
-uniform bool useNormalColor;
+// 每個 brick 是否在目前的 transfer function 下可見 (R8, one texel per brick)
+uniform sampler3D occupancy;
+// Pre-integrated transfer function, texture coordinate (front value, back value) of a ray segment
+uniform sampler2D preintegration_table;
+// 每個 brick 內數值的變化量 (R8)，變化小的地方用比較大的間距取樣
+uniform sampler3D brick_importance;
+
+vec3 OctahedralDecode(vec2 encoded) {
+    // (0, 0) 是沒有方向的 gradient（均勻的區域），和 RGBA32F 一樣還原成零向量
+    vec2 texel = encoded * 65535.0f;
+    if (texel.x < 0.5f && texel.y < 0.5f) {
+        return vec3(0.0f);
+    }
+    vec2 e = (texel - 1.0f) / 65534.0f * 2.0f - 1.0f;
+    vec3 n = vec3(e.x, e.y, 1.0f - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0f);
+    n.x += n.x >= 0.0f ? -t : t;
+    n.y += n.y >= 0.0f ? -t : t;
+    return normalize(n);
+}
 
-uniform float bloomThreshold;
+// Normalized voxel value (value / max value)
+float SampleValue(vec3 position) {
+#if VOLUME_LAYOUT == 0
+    return texture(volume, position).a;
+#else
+    return texture(volume, position).r * value_scale;
+#endif
+}
 
-uniform Light light;
+vec3 SampleNormal(vec3 position) {
+#if VOLUME_LAYOUT == 0
+    return texture(volume, position).rgb;
+#elif VOLUME_LAYOUT == 1
+    return texture(normal_volume, position).rgb;
+#else
+    return OctahedralDecode(texture(normal_volume, position).rg);
+#endif
+}
 
 vec3 BlinnPhongShading(vec3 normal, vec3 color, vec3 position) {
     // Ambient
     float ambient_strength = 0.2f;
-    vec3 ambient = ambient_strength * light.color;
+    vec3 ambient = ambient_strength * lightColor;
 
     // Diffuse
     float diffuse_strength = 0.75f;
     vec3 norm = normalize(normal);
-    vec3 lightDir = normalize(light.position - position);
+    vec3 lightDir = normalize(lightPosition - position);
     float diff = dot(norm, lightDir);
     if (diff <= 0) {
         diff *= -1;
         norm = -norm;
     }
-    vec3 diffuse = diffuse_strength * diff * light.color;
+    vec3 diffuse = diffuse_strength * diff * lightColor;
 
     // Specular
     float specular_strength = 0.4f;
     vec3 viewDir = normalize(viewPos - position);
     vec3 halfway = normalize(lightDir + viewDir);
     float spec = pow(max(dot(norm, halfway), 0.0f), shininess);
-    vec3 specular = specular_strength * spec * light.color;
+    vec3 specular = specular_strength * spec * lightColor;
 
     vec3 result = clamp(vec3(ambient + diffuse + specular) * color, 0.0f, 1.0f);
     return result;
@@ -57,53 +121,110 @@ vec3 BlinnPhongShading(vec3 normal, vec3 color, vec3 position) {
 
 void main () {
     vec4 result = vec4(background_color, 0.0f);
-    vec3 ray_direction = normalize(fs_in.FragPos - viewPos);
 
-    vec3 sample_pos = fs_in.TexCoord;
-    vec3 current_pos = fs_in.FragPos;
-
-    while (true) {
-        // 透過 sample_pos 取樣 volume 的法向量以及 Volume Value (對應顏色)
-        vec4 volume_data = texture(volume, sample_pos);
-        vec4 volume_color = texture(transfer_function, volume_data.a);
-        if (useNormalColor) {
-            volume_color.r = volume_data.r;
-            volume_color.g = volume_data.g;
-            volume_color.b = volume_data.b;
-        }
-
-        // 取樣後立即更新位置(沿著視線)，而實際的位置也改變，相對材質座標也要改變
-        current_pos = current_pos + ray_direction * sample_rate;
-        vec3 ray_direction_in_texture = vec3(1.0f);
-        vec3 actual_res = volume_resolution * volume_ratio;
-        ray_direction_in_texture.x = ray_direction.x / (actual_res.x);
-        ray_direction_in_texture.y = ray_direction.y / (actual_res.y);
-        ray_direction_in_texture.z = ray_direction.z / (actual_res.z);
-        sample_pos = sample_pos + ray_direction_in_texture * sample_rate;
-
-        // 如果射線出界了請離開迴圈
-        if (current_pos.x < -actual_res.x / 2.0f || current_pos.x > actual_res.x / 2.0f) {
-            break;
-        }
-        if (current_pos.y < -actual_res.y / 2.0f || current_pos.y > actual_res.y / 2.0f) {
+    // 光線設定只做一次：在材質座標 [0, 1]^3 中求出射線進入與離開 volume 的距離 (slab method)
+    // t 是世界座標中沿著視線的距離，所以取樣間距仍然是 sample_rate
+    vec3 actual_res = volume_resolution * volume_ratio;
+    vec3 ray_direction = normalize(fs_in.FragPos - viewPos);
+    vec3 direction_in_texture = ray_direction / actual_res;
+    vec3 inverse_direction = 1.0f / mix(direction_in_texture, vec3(1e-8f), lessThan(abs(direction_in_texture), vec3(1e-8f)));
+
+#ifdef USE_LEGACY_RAY_SETUP
+    // 原本的做法（用來比較）：從 proxy cube 正面的片段開始，每一步都檢查世界座標是否還在 volume 裡面
+    vec3 entry_pos = fs_in.TexCoord;
+    float t_length = 3.4e38f;
+#else
+    vec3 t_near = (vec3(0.0f) - camera_in_texture) * inverse_direction;
+    vec3 t_far = (vec3(1.0f) - camera_in_texture) * inverse_direction;
+    vec3 t_min = min(t_near, t_far);
+    vec3 t_max = max(t_near, t_far);
+    // 攝影機在 volume 裡面的時候，射線從攝影機的位置開始
+    float t_enter = max(max(max(t_min.x, t_min.y), t_min.z), 0.0f);
+    float t_exit = min(min(t_max.x, t_max.y), t_max.z);
+
+    vec3 entry_pos = camera_in_texture + direction_in_texture * t_enter;
+    float t_length = max(t_exit - t_enter, 0.0f);
+#endif
+
+#ifdef USE_BRICKS
+    vec3 last_brick = ceil(volume_resolution / brick_size) - 1.0f;
+#endif
+
+    // 上一個取樣點的數值，segment 從它到目前的取樣點；負值代表還沒有上一個點（剛進入或剛跳過透明的 brick）
+    float front_value = -1.0f;
+    float previous_step = sample_rate;
+    float sample_count = 0.0f;
+
+    // t 從進入點開始量，每一步至少前進 sample_rate
+    float t = 0.0f;
+    while (t < t_length) {
+        vec3 sample_pos = entry_pos + direction_in_texture * t;
+        float step_length = sample_rate;
+#ifdef USE_LEGACY_RAY_SETUP
+        vec3 bound_pos = sample_pos * actual_res - actual_res / 2.0f;
+        if (any(lessThan(bound_pos, -actual_res / 2.0f)) || any(greaterThan(bound_pos, actual_res / 2.0f))) {
             break;
         }
-        if (current_pos.z < -actual_res.z / 2.0f || current_pos.z > actual_res.z / 2.0f) {
-            break;
+#endif
+
+#ifdef USE_BRICKS
+        vec3 brick = min(floor(clamp(sample_pos, 0.0f, 1.0f) * volume_resolution / brick_size), last_brick);
+
+#ifdef USE_EMPTY_SPACE_SKIPPING
+        // 整個 brick 都是透明的話，直接跳到離開 brick 之後的第一個取樣點（跳過的取樣本來就不會有貢獻）
+        if (texelFetch(occupancy, ivec3(brick), 0).r == 0.0f) {
+            vec3 brick_min = brick * brick_size / volume_resolution;
+            vec3 brick_max = (brick + 1.0f) * brick_size / volume_resolution;
+            vec3 exit_plane = mix(brick_min, brick_max, step(0.0f, direction_in_texture));
+            vec3 t_to_exit = abs(exit_plane - sample_pos) * abs(inverse_direction);
+            t += (floor(min(t_to_exit.x, min(t_to_exit.y, t_to_exit.z)) / sample_rate) + 1.0f) * sample_rate;
+            front_value = -1.0f;
+            continue;
         }
+#endif
+
+#ifdef USE_ADAPTIVE_SAMPLING
+        float importance = texelFetch(brick_importance, ivec3(brick), 0).r;
+        step_length = sample_rate * mix(max_step_scale, 1.0f, clamp(importance / importance_threshold, 0.0f, 1.0f));
+#endif
+#endif
+        t += step_length;
+        sample_count += 1.0f;
+
+        // 透過 sample_pos 取樣 Volume Value (對應顏色)
+        float value = SampleValue(sample_pos);
+        vec4 volume_color;
+        // 這個取樣點代表的長度：逐點分類是往後的一步，pre-integration 則是從上一個取樣點到這裡的 segment
+        float segment_length = step_length;
+#ifdef USE_PREINTEGRATION
+        segment_length = front_value < 0.0f ? step_length : previous_step;
+        volume_color = texture(preintegration_table, vec2(front_value < 0.0f ? value : front_value, value));
+        front_value = value;
+#else
+        volume_color = texture(transfer_function, value);
+#endif
+        previous_step = step_length;
+#ifdef USE_NORMAL_COLOR
+        volume_color.rgb = SampleNormal(sample_pos);
+#endif
 
         // 如果發現該 voxel 透過 transfer function 得來的 alpha 值是 0，那就不用算光照直接看一個
         if (volume_color.a == 0) {
             continue;
         }
 
+        // Opacity correction: the same material looks the same whatever the step length is.
+#ifdef USE_OPACITY_CORRECTION
+        volume_color.a = 1.0f - pow(max(1.0f - volume_color.a, 0.0f), segment_length / reference_step);
+#endif
+
         // 計算光照
-        vec3 temp_color = vec3(0.0f);
-        if (useLighting) {
-            temp_color = BlinnPhongShading(volume_data.xyz, volume_color.rgb, current_pos);
-        } else {
-            temp_color = volume_color.rgb * 2.0f;
-        }
+#ifdef USE_LIGHTING
+        vec3 current_pos = sample_pos * actual_res - actual_res / 2.0f;
+        vec3 temp_color = BlinnPhongShading(SampleNormal(sample_pos), volume_color.rgb, current_pos);
+#else
+        vec3 temp_color = volume_color.rgb * 2.0f;
+#endif
 
         result.rgb += (1.0f - result.a) * volume_color.a * temp_color;
         result.a += (1.0f - result.a) * volume_color.a;
@@ -129,5 +250,6 @@ void main () {
     }
 
     BrightColor = vec4(bright_color.rgb, 1.0f);
+    RayStatistics = vec4(sample_count, 1.0f, 0.0f, 1.0f);
     FragColor = final_frag_color;
 }
\ No newline at end of file
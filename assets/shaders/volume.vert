@@ -7,9 +7,35 @@ out VS_OUT {
     vec3 TexCoord;
 } vs_out;
 
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+// Per view, written once by MasterRenderer (FrameUniforms, binding 0)
+layout (std140) uniform FrameData {
+    mat4 view;
+    mat4 projection;
+    vec3 viewPos;
+    float bloomThreshold;
+    vec3 lightPosition;
+    vec3 lightColor;
+};
+
+// Per draw, written once by VolumeRenderer (VolumeUniforms, binding 1)
+layout (std140) uniform VolumeData {
+    mat4 model;
+    vec3 volume_resolution;
+    float sample_rate;
+    // 每個 voxel 的大小
+    vec3 volume_ratio;
+    // VOLUME_LAYOUT 0: RGBA32F (normal in rgb, value in a), 1: scalar + RGB8_SNORM normal, 2: scalar + RG16 octahedral normal
+    float value_scale;
+    // 攝影機在材質座標中的位置
+    vec3 camera_in_texture;
+    float brick_size;
+    vec3 background_color;
+    // The alpha of the transfer function is the opacity of a sample over this step length.
+    float reference_step;
+    float max_step_scale;
+    float importance_threshold;
+    float shininess;
+};
 
 void main() {
     vs_out.FragPos = vec3(model * vec4(aPosition, 1.0f));
@@ -5,6 +5,17 @@
 
 #include "Config.hpp"
 #include "Game.hpp"
+#include "GL/TimerQuery.hpp"
+#include "Utility/AllocationCounter.hpp"
+
+// The passes of a frame which are timed in the benchmark mode.
+enum class FramePass : unsigned int {
+    Volume,
+    Bloom,
+    Screen,
+    GUI,
+    Count,
+};
 
 struct Application {
     explicit Application(const Config& config);
@@ -12,10 +23,19 @@ struct Application {
 
     void Initialize();
     void Run();
+    // render_scene = false reuses the volume and bloom results of the last frame, only the screen and the GUI are drawn.
+    // It is ignored when the frame graph had to be rebuilt.
+    void RenderFrame(TimerQuery* timer = nullptr, bool render_scene = true);
+    void RunBenchmark();
 
     float current_time = 0.0f;
     float delta_time = 0.0f;
     float last_time = 0.0f;
+    // Quiet frames (no event, no change) before the main loop blocks on SDL_WaitEventTimeout()
+    static constexpr int IdleFramesBeforeWaiting = 3;
+    static constexpr int IdleWaitTimeout = 250;
+    // Heap allocations of the scene and screen passes (without the GUI), summed over the frames
+    AllocationCounter::Totals render_allocations;
     const Config& my_config;
     std::unique_ptr<Game> game;
 };
@@ -3,7 +3,7 @@
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
-#include <vector>
+#include <array>
 
 #include "World/Entity.hpp"
 
@@ -39,8 +39,8 @@ struct Camera {
         float near;
         float far;
     } frustum;
-    std::vector <glm::vec4> near_plane_vertex;
-    std::vector <glm::vec4> far_plane_vertex;
+    std::array<glm::vec4, 4> near_plane_vertex {};
+    std::array<glm::vec4, 4> far_plane_vertex {};
 
     float AspectRatio() const;
     glm::mat4 View() const;
@@ -13,6 +13,33 @@ struct Config {
     // OpenGL Settings
     int opengl_major_version = 3;
     int opengl_minor_version = 3;
+
+    // Worker threads for volume preprocessing (including the calling thread), 0 means all hardware threads
+    unsigned int worker_threads = 0;
+
+    // Linked shader programs are kept here between runs, empty (--no-shader-cache) compiles every shader from source
+    std::string shader_cache_directory = "cache/shaders";
+
+    // Swap synchronized with the monitor's vertical refresh
+    bool vsync = true;
+
+    // The previous full resolution ping-pong bloom instead of the mip chain (--gaussian-bloom), e.g. to compare gpu_bloom_ms
+    bool gaussian_bloom = false;
+    // The previous ray setup of the volume shader instead of the slab test (--legacy-ray-setup), to compare gpu_volume_ms
+    bool legacy_ray_setup = false;
+
+    // Benchmark Mode (--benchmark): hidden window, no vsync, an orbit camera path and per-frame timings as CSV
+    bool benchmark = false;
+    std::string benchmark_volume = "assets/volumes/engine.toml";
+    std::string benchmark_transfer_function = "assets/transfer_functions/engine.toml";
+    std::string benchmark_output = "benchmark.csv";
+    int benchmark_frames = 360;
+    int benchmark_warmup_frames = 30;
+
+    // CPU Rendering (--cpu-render): renders benchmark_volume with benchmark_transfer_function on the CPU, no window
+    bool cpu_render = false;
+    bool cpu_render_scaling = false;
+    std::string cpu_render_image = "cpu_render.png";
 };
 
 #endif
\ No newline at end of file
@@ -3,6 +3,7 @@
 
 #include <glad/glad.h>
 
+#include <initializer_list>
 #include <vector>
 #include <memory>
 #include <iostream>
@@ -19,8 +20,13 @@ struct FrameBuffer {
     void Bind();
     void UnBind();
     void SetDrawBufferAmount(int amount);
+    // Draw into the color attachments which are enabled, the others are GL_NONE and not written.
+    void SetDrawBuffers(std::initializer_list<bool> enabled);
     void BindTexture2D(const Texture2D& texture, unsigned int attachment = 0);
+    void DetachTexture2D(unsigned int attachment = 0);
     void BindRenderBuffer(const std::unique_ptr<RenderBuffer>& rbo);
+    // Scale the (0, 0, width, height) region of a color attachment onto the same attachment of the target.
+    void BlitColor(FrameBuffer& target, unsigned int attachment, int width, int height, int target_width, int target_height);
     void CheckComplete();
 };
 #endif
\ No newline at end of file
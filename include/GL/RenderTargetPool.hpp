@@ -0,0 +1,98 @@
+#ifndef RENDERTARGETPOOL_HPP
+#define RENDERTARGETPOOL_HPP
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "GL/FrameBuffer.hpp"
+#include "Texture/TextureManager.hpp"
+
+// A color target drawn into its lower left (0, 0, width, height) corner, the storage may be larger.
+struct RenderTarget {
+    TextureHandle texture {};
+    // The part in use
+    int width = 0;
+    int height = 0;
+    // The storage, a multiple of RenderTargetPool::Bucket
+    int allocated_width = 0;
+    int allocated_height = 0;
+
+    // The part in use in texture coordinates, samplers scale their coordinates by it.
+    glm::vec2 Region() const;
+};
+
+using TransientTarget = int;
+
+/**
+ * RGB16F render targets whose storage grows in buckets instead of following the window exactly.
+ *
+ * 拖曳視窗的時候大部分的新大小都還在同一個 bucket 裡，只要更新使用中的範圍，不必重新配置。
+ * Persistent targets (attachments of a fixed framebuffer) are resized with Fit(). Transient targets are handed out by
+ * Acquire() with a framebuffer of their own and go back with Release(), so a later pass of the same size reuses them.
+ */
+struct RenderTargetPool {
+    static constexpr int Bucket = 128;
+    // A free transient target is deleted after this many frames without being acquired.
+    static constexpr int TrimFrames = 120;
+
+    struct Counters {
+        // Texture storage created or re-specified since the start, and its bytes
+        std::size_t allocations = 0;
+        std::size_t allocated_bytes = 0;
+        // Acquire() served by a target which already existed
+        std::size_t reuses = 0;
+        // Storage held by the pool right now
+        std::size_t live_bytes = 0;
+    };
+
+    static RenderTargetPool& Shared();
+
+    RenderTargetPool(const RenderTargetPool&) = delete;
+    RenderTargetPool& operator=(const RenderTargetPool&) = delete;
+
+    // Rounded up to a multiple of Bucket
+    static int BucketSize(int size);
+
+    RenderTarget Create(const std::string& name, int width, int height);
+    // Use width x height of the target, the storage changes only when it is too small or more than twice the area needed.
+    // Returns whether the storage was re-specified.
+    bool Fit(RenderTarget& target, int width, int height);
+
+    // A free target with a storage of the bucket of width x height, created if there is none.
+    TransientTarget Acquire(int width, int height);
+    void Release(TransientTarget transient);
+    const RenderTarget& Target(TransientTarget transient) const;
+    FrameBuffer& Framebuffer(TransientTarget transient);
+
+    // Delete the transient targets nobody acquired for TrimFrames frames.
+    void EndFrame();
+
+    const Counters& GetCounters() const;
+
+    // Delete the framebuffers of the transient targets while the OpenGL context is still alive, TextureManager::Destroy() deletes the textures.
+    void Destroy();
+
+private:
+    RenderTargetPool() = default;
+
+    struct Entry {
+        RenderTarget target;
+        std::unique_ptr<FrameBuffer> framebuffer;
+        bool alive = false;
+        bool in_use = false;
+        long long last_used = 0;
+    };
+
+    void CountAllocation(TextureHandle texture, std::size_t previous_bytes);
+
+    std::vector<Entry> m_entries;
+    long long m_frame = 0;
+    Counters m_counters {};
+};
+
+#endif
@@ -0,0 +1,41 @@
+#ifndef TIMERQUERY_HPP
+#define TIMERQUERY_HPP
+
+#include <glad/glad.h>
+
+#include <vector>
+
+/**
+ * GPU time of a fixed set of passes per frame (GL_TIME_ELAPSED).
+ *
+ * 查詢結果要等 GPU 真的執行完才拿得到，所以保留好幾個 frame 的 query，
+ * 讀取 frames_in_flight 之前的結果就不會讓 CPU 停下來等 GPU。
+ * GL_TIME_ELAPSED 不能巢狀，同一時間只能有一個 pass 在計時。
+ */
+struct TimerQuery {
+    explicit TimerQuery(int pass_count, int frames_in_flight = 4);
+    ~TimerQuery();
+
+    TimerQuery(const TimerQuery&) = delete;
+    TimerQuery& operator=(const TimerQuery&) = delete;
+
+    // Select the queries of the frame, the results of frame - frames_in_flight must be resolved before this.
+    void BeginFrame(long long frame_index);
+    void Begin(int pass);
+    void End();
+
+    // Milliseconds per pass of an earlier frame (blocks until the GPU has finished it), 0 for passes not timed.
+    std::vector<double> Resolve(long long frame_index);
+
+    int PassCount() const;
+    int FramesInFlight() const;
+
+private:
+    int m_pass_count;
+    int m_frames_in_flight;
+    int m_current_slot;
+    std::vector<GLuint> m_queries;
+    std::vector<bool> m_issued;
+};
+
+#endif
@@ -0,0 +1,27 @@
+#ifndef UNIFORMBUFFER_HPP
+#define UNIFORMBUFFER_HPP
+
+#include <glad/glad.h>
+
+/**
+ * A uniform buffer object attached to a fixed binding point.
+ *
+ * Programs find it through Shader::BindUniformBlock() with the same binding, so one upload per frame
+ * serves every program and every permutation which declares the block.
+ */
+struct UniformBuffer {
+    UniformBuffer(GLsizeiptr size, GLuint binding);
+    ~UniformBuffer();
+
+    UniformBuffer(const UniformBuffer&) = delete;
+    UniformBuffer& operator=(const UniformBuffer&) = delete;
+
+    // Replace the whole contents, data has to be the std140 layout of the block.
+    void Update(const void* data);
+
+    GLuint ID;
+    GLsizeiptr size;
+    GLuint binding;
+};
+
+#endif
@@ -9,7 +9,8 @@
 
 struct CubicBezier {
     static std::vector<float> m_coefficient;
-    static std::vector<ImVec2> BezierTable(const std::array<ImVec2, 4>& control_points, const unsigned int& sample_points);
+    // Overwrites results with sample_points + 1 points, its capacity is reused.
+    static void BezierTable(const std::array<ImVec2, 4>& control_points, const unsigned int& sample_points, std::vector<ImVec2>& results);
     static float BezierValue(const float& t, const std::array<ImVec2, 2>& points);
 
 };
@@ -33,6 +33,9 @@ struct CubicBezierWidget {
 private:
     void DrawPresetSelector();
     bool DrawCanvas();
+
+    // The evaluated curve, kept between the frames
+    std::vector<ImVec2> m_curve;
 };
 
 #endif
@@ -6,6 +6,7 @@
 #include <string>
 #include "GUI/CubicBezierWidget.hpp"
 #include "GUI/TransferFunctionWidget.hpp"
+#include "Utility/Profiler.hpp"
 
 struct GUI {
     GUI(SDL_Window* window, SDL_GLContext glContext);
@@ -47,6 +48,11 @@ struct GUI {
             bool Visible = false;
             int WindowFlags = 0;
         } CubicBezier;
+        struct Profiler {
+            bool Visible = false;
+            int WindowFlags = 0;
+            float RowHeight = 20.0f;
+        } Profiler;
 #ifndef NDEBUG
         struct Demo {
             bool Visible = false;
@@ -70,9 +76,14 @@ private:
     void AboutRender();
     void TransferFunctionRender();
     void CubicBezierRender();
+    void ProfilerRender();
 
     void ErrorNoVolumeFilesModal();
     void ErrorNoChoseVolumeFileModal();
+
+    // Kept between the frames of the profiler panel
+    std::vector<float> m_profiler_plot;
+    std::vector<::Profiler::Average> m_profiler_averages;
 };
 
 #endif
\ No newline at end of file
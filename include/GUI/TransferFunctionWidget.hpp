@@ -15,9 +15,26 @@ enum class Channel : unsigned int {
 
 struct TransferFunctionWidget {
 public:
+    // Texels [begin, end) of the colormap and the channels (bit i = Channel i) that changed.
+    struct TexelRange {
+        int begin = 0;
+        int end = 0;
+        unsigned int channels = 0;
+
+        bool Empty() const { return begin >= end; }
+    };
+
     TransferFunctionWidget();
-    bool DrawUI(const std::string& label, const int& domain);
-    std::vector<float> GetColorData() const;
+    bool DrawUI(const char* label, const int& domain);
+    // RGBA of every texel of the domain, kept up to date as the control points are edited.
+    const std::vector<float>& GetColorData() const;
+    // What the last DrawUI() / LoadPreset() changed in GetColorData().
+    const TexelRange& GetChangedRange() const;
+    // Increases with every change of the colormap.
+    std::size_t GetVersion() const;
+
+    // Replace the control points with a preset (TOML, one [x, y] list per channel), false if it can not be loaded.
+    bool LoadPreset(const std::string& file_path);
 
 private:
     struct WidgetConfig {
@@ -36,7 +53,10 @@ private:
     std::size_t m_current_control_pt;
     std::array<std::vector<ImVec2>, 4> m_control_pts;
 
+    // 拖曳控制點時只會重算該 channel 在左右兩個鄰居之間的 texel，不會重新配置記憶體
     std::vector<float> m_colormap;
+    TexelRange m_changed;
+    std::size_t m_version = 0;
 
     ImVec2 m_canvas_size;
     ImVec2 m_origin;
@@ -46,6 +66,8 @@ private:
     void InitialControlPoints();
     void DrawCanvas();
     bool HandleEvents();
+    void ResizeColormap();
+    void UpdateColormap(std::size_t channel, float x_min, float x_max);
 
     inline ImColor ChangeColorAlpha(const ImColor& color, const float& alpha) const;
     inline ImVec2 ScreenCoord(const ImVec2& pos) const;
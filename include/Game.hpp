@@ -13,21 +13,38 @@
 
 #include "GL/FrameBuffer.hpp"
 #include "GL/RenderBuffer.hpp"
+#include "GL/RenderTargetPool.hpp"
 
+#include "Renderer/FrameGraph.hpp"
 #include "Renderer/MasterRenderer.hpp"
 #include "Utility/MatrixStack.hpp"
+#include "World/World.hpp"
 
 struct Game {
     Game();
 
-    void RendererInit();
-    void RenderGaussianBlur();
+    // Rebuild the frame graph when the bloom settings or the settled render size changed, resize its targets while a resize is pending.
+    // Returns whether it did either: the graph has no results of an earlier frame then, the scene has to be rendered.
+    bool PrepareFrameGraph();
+    // The stages of the frame graph
+    void RenderScene();
+    // The bloom of the selected method, the result stays in a retained target until the scene is rendered again.
+    void RenderBloom();
     void RenderScreen();
+    // Average samples per ray of the last rendered volume, only with World::use_ray_statistics.
+    // Every RayStatisticsInterval rendered frames a read back is started, its result is taken a frame or two later once the fence signals.
+    void UpdateRayStatistics(bool scene_rendered);
     void Update(float dt);
     void Render(const std::unique_ptr<Camera>& current_camera);
     void Destroy();
 
     void HandleEvents();
+    // Whether the last HandleEvents() got any event, or a resize is still waiting.
+    bool HasEvents() const;
+
+    // The size the scene is drawn at, the window size unless the targets are still waiting for a resize.
+    int RenderWidth() const;
+    int RenderHeight() const;
 
 private:
     void PollEvents();
@@ -42,6 +59,54 @@ private:
     void OnWindowEvent(const SDL_WindowEvent& e);
 
     void UpdateFramebuffer();
+    void UpdateRenderSize();
+
+    void RendererInit();
+    void BuildFrameGraph();
+    // The created resources of the graph follow the render size
+    void ResizeFrameGraph();
+    // Bind the framebuffer of a transient resource and set the viewport to its size.
+    void BindFrameTarget(FrameResource resource);
+    // What is attached to a framebuffer and drawn into besides attachment 0
+    struct AttachedTargets {
+        TextureHandle bloom {};
+        bool ray_statistics = true;
+    };
+    // Attachment 1 of the framebuffer is the texture, or nothing and not drawn into with an invalid handle.
+    // Attachment 2 is drawn into only while the ray statistics are on.
+    static void AttachTargets(FrameBuffer& framebuffer, TextureHandle bloom, AttachedTargets& attached);
+    // Start a read back of the mean of the statistics target into the pixel buffer.
+    void ReadRayStatistics(const RenderTarget& target);
+
+    // What the structure of the frame graph depends on, the size is the one of the last settled resize
+    struct FrameGraphKey {
+        bool use_bloom = false;
+        BloomMethod bloom_method = BloomMethod::MIP_CHAIN;
+        int bloom_strength = 0;
+        int bloom_mip_levels = 0;
+        int width = 0;
+        int height = 0;
+
+        bool Differs(const FrameGraphKey& other) const;
+    };
+
+    // 拖曳視窗邊緣時 SDL 會連續送出 resize 事件，大小停止變化 ResizeDelay 毫秒之後才調整 render target
+    static constexpr Uint32 ResizeDelay = 150;
+    bool resize_pending = false;
+    Uint32 resize_time = 0;
+    int render_width = 0;
+    int render_height = 0;
+    // The render size when the targets were last fitted, it changes only once a resize has settled
+    int settled_width = 0;
+    int settled_height = 0;
+
+    static constexpr int RayStatisticsInterval = 30;
+    int frames_since_ray_statistics = 0;
+    // The statistics target the volume was drawn into last, the reduced one while interacting
+    const RenderTarget* ray_statistics_target = nullptr;
+    // Pixel buffer of the read back in flight, done once the fence signals
+    GLuint ray_statistics_buffer = 0;
+    GLsync ray_statistics_fence = nullptr;
 
     std::vector<SDL_Event> events = {};
 
@@ -50,10 +115,32 @@ private:
 
     // Framebuffer
     std::unique_ptr<FrameBuffer> main_framebuffer = nullptr;
-    std::array<std::unique_ptr<FrameBuffer>, 2> gaussian_blur_framebuffer = { nullptr, nullptr };
+    // The same attachments as the main framebuffer at half of its size, for the reduced quality levels
+    std::unique_ptr<FrameBuffer> reduced_framebuffer = nullptr;
 
-    // Renderbuffer
+    // Renderbuffer, the size of the storage of the main targets
     std::unique_ptr<RenderBuffer> main_renderbuffer = nullptr;
+
+    // Attachments 0 and 2 of the framebuffers above (PostProcessing, RayStatistics), from the RenderTargetPool.
+    // Attachment 1 (Bloom) is a transient of the frame graph, attached only while a bloom pass reads it.
+    std::array<RenderTarget, 2> main_targets {};
+    std::array<RenderTarget, 2> reduced_targets {};
+    AttachedTargets main_attached {};
+    AttachedTargets reduced_attached {};
+
+    FrameGraph frame_graph;
+    FrameGraphKey frame_graph_key {};
+    bool has_frame_graph = false;
+    // The Bloom attachment of the scene pass
+    FrameResource bright = -1;
+    // The created resources and the bloom mip level of each (-1 for the full size)
+    struct SizedResource {
+        FrameResource resource;
+        int level;
+    };
+    std::vector<SizedResource> sized_resources;
+    int frame_graph_width = 0;
+    int frame_graph_height = 0;
 };
 
 #endif
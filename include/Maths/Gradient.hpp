@@ -2,14 +2,137 @@
 #define GRADIENT_HPP
 
 #include <glm/glm.hpp>
+#include <type_traits>
 #include <vector>
+#include "Maths/GradientKernel.hpp"
 #include "Maths/IntegerVector.hpp"
 #include "Model/Volume.hpp"
 
 namespace Maths {
     struct Gradient {
+        // Defined in the header so every sample type gets its own inlined instance in the caller's loop.
+        template<typename T>
         static glm::vec3 Compute(const int& i, const int& j, const int& k, const Volume& volume);
+
+        /**
+         * Gradients of a whole z-slice, written to normals[j * res.x + i].
+         * Interior rows go through the SIMD kernel, only the voxels on the faces of the volume use Compute().
+         * The scratch buffer is reused between calls, keep one per thread.
+         */
+        template<typename T>
+        static void ComputeSlice(const int& k, const Volume& volume, glm::vec3* normals, std::vector<float>& scratch);
     };
+
+    template<typename T>
+    glm::vec3 Gradient::Compute(const int &i, const int &j, const int &k, const Volume& volume) {
+        const ivec3& resolution = volume.m_info.resolution;
+        const auto value = [&volume](const int& x, const int& y, const int& z) {
+            return static_cast<float>(volume.GetVoxelVal<T>(x, y, z));
+        };
+        auto norm = glm::vec3(0.0f);
+
+        // x-axis
+        if (i + 1 >= resolution.x) {
+            // Backward Difference
+            norm.x = (value(i, j, k) - value(i - 1, j, k)) / static_cast<float>(resolution.x);
+        } else if (i - 1 < 0) {
+            // Forward Difference
+            norm.x = (value(i + 1, j, k) - value(i, j, k)) / static_cast<float>(resolution.x);
+        } else {
+            // Central Difference
+            norm.x = (value(i + 1, j, k) - value(i - 1, j, k)) / (2 * static_cast<float>(resolution.x));
+        }
+
+        // y-axis
+        if (j + 1 >= resolution.y) {
+            // Backward Difference
+            norm.y = (value(i, j, k) - value(i, j - 1, k)) / static_cast<float>(resolution.y);
+        } else if (j - 1 < 0) {
+            // Forward Difference
+            norm.y = (value(i, j + 1, k) - value(i, j, k)) / static_cast<float>(resolution.y);
+        } else {
+            // Central Difference
+            norm.y = (value(i, j + 1, k) - value(i, j - 1, k)) / (2 * static_cast<float>(resolution.y));
+        }
+
+        // z-axis
+        if (k + 1 >= resolution.z) {
+            // Backward Difference
+            norm.z = (value(i, j, k) - value(i, j, k - 1)) / static_cast<float>(resolution.z);
+        } else if (k - 1 < 0) {
+            // Forward Difference
+            norm.z = (value(i, j, k + 1) - value(i, j, k)) / static_cast<float>(resolution.z);
+        } else {
+            // Central Difference
+            norm.z = (value(i, j, k + 1) - value(i, j, k - 1)) / (2 * static_cast<float>(resolution.z));
+        }
+
+        return norm;
+    }
+
+    template<typename T>
+    void Gradient::ComputeSlice(const int& k, const Volume& volume, glm::vec3* normals, std::vector<float>& scratch) {
+        const ivec3& resolution = volume.m_info.resolution;
+        const auto boundary_row = [&](const int& j) {
+            for (int i = 0; i < resolution.x; i++) {
+                normals[j * resolution.x + i] = Compute<T>(i, j, k, volume);
+            }
+        };
+
+        // 整個 slice 都在邊界上
+        const int interior_count = resolution.x - 2;
+        if (k == 0 || k + 1 >= resolution.z || resolution.y < 3 || interior_count <= 0) {
+            for (int j = 0; j < resolution.y; j++) {
+                boundary_row(j);
+            }
+            return;
+        }
+
+        // Five converted input rows and the three gradient components of the interior.
+        scratch.resize(8 * static_cast<std::size_t>(resolution.x));
+        float* gx = scratch.data() + 5 * resolution.x;
+        float* gy = gx + interior_count;
+        float* gz = gy + interior_count;
+
+        const T* voxels = volume.GetVoxels<T>().data();
+        const auto row_at = [&](const int& j, const int& z, const int& slot) -> const float* {
+            const T* source = voxels + volume.GetIndex(0, j, z);
+            if constexpr (std::is_same_v<T, float>) {
+                return source;
+            } else {
+                float* row = scratch.data() + slot * resolution.x;
+                for (int i = 0; i < resolution.x; i++) {
+                    row[i] = static_cast<float>(source[i]);
+                }
+                return row;
+            }
+        };
+
+        // Same denominators as the central difference in Compute(), so the results are bit-identical.
+        const float denom_x = 2 * static_cast<float>(resolution.x);
+        const float denom_y = 2 * static_cast<float>(resolution.y);
+        const float denom_z = 2 * static_cast<float>(resolution.z);
+
+        boundary_row(0);
+        for (int j = 1; j + 1 < resolution.y; j++) {
+            const GradientKernel::Row row = {
+                row_at(j, k, 0),
+                row_at(j - 1, k, 1),
+                row_at(j + 1, k, 2),
+                row_at(j, k - 1, 3),
+                row_at(j, k + 1, 4),
+            };
+            GradientKernel::CentralDifference(row, interior_count, denom_x, denom_y, denom_z, gx, gy, gz);
+
+            glm::vec3* output = normals + j * resolution.x;
+            output[0] = Compute<T>(0, j, k, volume);
+            for (int n = 0; n < interior_count; n++) {
+                output[n + 1] = glm::vec3(gx[n], gy[n], gz[n]);
+            }
+            output[resolution.x - 1] = Compute<T>(resolution.x - 1, j, k, volume);
+        }
+        boundary_row(resolution.y - 1);
+    }
 }
 
 #endif
@@ -0,0 +1,19 @@
+#ifndef GRADIENTBENCHMARK_HPP
+#define GRADIENTBENCHMARK_HPP
+
+#include <string>
+
+namespace Maths {
+    /**
+     * Compares the SIMD gradient path against the per-voxel Gradient::Compute on a volume:
+     * every available instruction set must produce bit-identical normals, and the cost of each is reported.
+     *
+     * Usage: volume_renderer --gradient-benchmark assets/volumes/engine.toml
+     */
+    struct GradientBenchmark {
+        // Returns 0 when every kernel matches the reference.
+        static int Run(const std::string& info_file, int repeat = 5);
+    };
+}
+
+#endif
@@ -0,0 +1,41 @@
+#ifndef GRADIENTKERNEL_HPP
+#define GRADIENTKERNEL_HPP
+
+#include <string>
+
+namespace Maths {
+    enum class SimdLevel : unsigned int {
+        Scalar,
+        SSE,
+        AVX2,
+    };
+
+    /**
+     * Central differences over contiguous x-rows of interior voxels.
+     *
+     * 每一個 row 只做減法與除法，沒有任何分支；邊界上的 voxel 交給 Gradient::Compute 處理。
+     * 指令集在執行期依 CPU 選擇，除法（而不是乘上倒數）讓結果與 Gradient::Compute 完全一致。
+     */
+    struct GradientKernel {
+        struct Row {
+            const float* center;   // (i, j, k), i is in [0, count + 2)
+            const float* y_prev;   // (i, j - 1, k)
+            const float* y_next;   // (i, j + 1, k)
+            const float* z_prev;   // (i, j, k - 1)
+            const float* z_next;   // (i, j, k + 1)
+        };
+
+        // Writes the gradient of the voxels [1, count + 1) of the row into gx, gy and gz (count floats each).
+        // The denominators are 2 * resolution of each axis.
+        static void CentralDifference(const Row& row, int count, float denom_x, float denom_y, float denom_z,
+                                      float* gx, float* gy, float* gz);
+
+        static SimdLevel Detect();
+        static SimdLevel Level();
+        // Forcing a level the CPU does not support falls back to the detected one.
+        static void SetLevel(SimdLevel level);
+        static std::string ShowLevel(SimdLevel level);
+    };
+}
+
+#endif
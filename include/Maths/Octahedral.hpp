@@ -0,0 +1,54 @@
+#ifndef OCTAHEDRAL_HPP
+#define OCTAHEDRAL_HPP
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace Maths {
+    /**
+     * Quantization helpers for unit normals.
+     *
+     * Octahedral encoding 把單位球投影到八面體再攤平成 [-1, 1]^2，兩個分量就能表示方向，
+     * decode 的部份在 volume.frag 的 OctahedralDecode()。
+     */
+    struct Octahedral {
+        // A zero vector stays zero (e.g. homogeneous regions of the volume).
+        static glm::vec3 Normalize(const glm::vec3& vector) {
+            const float length = std::sqrt(vector.x * vector.x + vector.y * vector.y + vector.z * vector.z);
+            return length > 0.0f ? vector / length : glm::vec3(0.0f);
+        }
+
+        // Unit vector to [-1, 1]^2
+        static glm::vec2 Encode(const glm::vec3& unit) {
+            const float l1 = std::abs(unit.x) + std::abs(unit.y) + std::abs(unit.z);
+            if (l1 == 0.0f) {
+                return glm::vec2(0.0f);
+            }
+
+            glm::vec2 p = glm::vec2(unit.x / l1, unit.y / l1);
+            if (unit.z < 0.0f) {
+                // Fold the lower hemisphere over the diagonals.
+                const glm::vec2 folded = glm::vec2(1.0f - std::abs(p.y), 1.0f - std::abs(p.x));
+                p = glm::vec2(p.x >= 0.0f ? folded.x : -folded.x, p.y >= 0.0f ? folded.y : -folded.y);
+            }
+            return p;
+        }
+
+        static int8_t ToSnorm8(float value) {
+            return static_cast<int8_t>(std::lround(std::clamp(value, -1.0f, 1.0f) * 127.0f));
+        }
+
+        // The texel of a zero vector, no direction is encoded to it (volume.frag decodes it back to zero).
+        static constexpr uint16_t ZeroSentinel = 0;
+
+        // [-1, 1] to [1, 65535] of an unsigned 16-bit channel (GL_RG16 samples it back as [0, 1]), 0 is the sentinel.
+        static uint16_t ToUnorm16(float value) {
+            return static_cast<uint16_t>(1 + std::lround((std::clamp(value, -1.0f, 1.0f) * 0.5f + 0.5f) * 65534.0f));
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,86 @@
+#ifndef BRICKGRID_HPP
+#define BRICKGRID_HPP
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "Maths/IntegerVector.hpp"
+#include "Utility/ThreadPool.hpp"
+
+/**
+ * Min/max of the normalized voxel values (value / max value) per brick of BrickSize^3 voxels.
+ *
+ * 每個 brick 的範圍會多包含一層鄰近的 voxel，因為三線性內插在 brick 邊界上也會讀到隔壁的 voxel。
+ * 配合目前的 transfer function 就能知道哪些 brick 完全透明，ray caster 可以直接跳過。
+ */
+struct BrickGrid {
+    static constexpr int BrickSize = 8;
+
+    template<typename T>
+    void Build(const T* voxels, const Maths::ivec3& resolution, float max_value);
+
+    // Recompute the occupancy from the RGBA colormap of the transfer function, cheap enough for every edit.
+    void UpdateOccupancy(const std::vector<float>& colormap);
+
+    std::size_t GetBrickCount() const;
+    std::size_t GetOccupiedCount() const;
+
+    Maths::ivec3 m_brick_count;
+    std::vector<glm::vec2> m_ranges;
+    // How much the values vary inside the brick (max - min, 0 ~ 255), adaptive sampling takes longer steps where it is low.
+    // The range of a brick with its halo also bounds the central differences, so it stands in for the gradient magnitude.
+    std::vector<uint8_t> m_importance;
+    // 255 if any voxel of the brick is visible with the current transfer function, 0 otherwise.
+    std::vector<uint8_t> m_occupancy;
+    std::size_t m_occupied_count = 0;
+    // Prefix sum of the visible texels, kept between the updates so dragging a control point does not allocate.
+    std::vector<int> m_visible_texels;
+};
+
+template<typename T>
+void BrickGrid::Build(const T* voxels, const Maths::ivec3& resolution, float max_value) {
+    m_brick_count = Maths::ivec3((resolution.x + BrickSize - 1) / BrickSize,
+                                 (resolution.y + BrickSize - 1) / BrickSize,
+                                 (resolution.z + BrickSize - 1) / BrickSize);
+    m_ranges.assign(GetBrickCount(), glm::vec2(0.0f));
+    m_importance.assign(GetBrickCount(), 0);
+    m_occupancy.assign(GetBrickCount(), 255);
+    m_occupied_count = GetBrickCount();
+
+    // Each task owns whole layers of bricks.
+    ThreadPool::Shared().ParallelFor(0, m_brick_count.z, 1, [&](int layer_begin, int layer_end) {
+        for (int bz = layer_begin; bz < layer_end; bz++) {
+            for (int by = 0; by < m_brick_count.y; by++) {
+                for (int bx = 0; bx < m_brick_count.x; bx++) {
+                    // One voxel of halo on every side
+                    const int x_begin = std::max(bx * BrickSize - 1, 0), x_end = std::min((bx + 1) * BrickSize + 1, resolution.x);
+                    const int y_begin = std::max(by * BrickSize - 1, 0), y_end = std::min((by + 1) * BrickSize + 1, resolution.y);
+                    const int z_begin = std::max(bz * BrickSize - 1, 0), z_end = std::min((bz + 1) * BrickSize + 1, resolution.z);
+
+                    T min_value = std::numeric_limits<T>::max();
+                    T max_value_in_brick = std::numeric_limits<T>::lowest();
+                    for (int z = z_begin; z < z_end; z++) {
+                        for (int y = y_begin; y < y_end; y++) {
+                            const T* row = voxels + (static_cast<std::size_t>(z) * resolution.y + y) * resolution.x;
+                            const auto range = std::minmax_element(row + x_begin, row + x_end);
+                            min_value = std::min(min_value, *range.first);
+                            max_value_in_brick = std::max(max_value_in_brick, *range.second);
+                        }
+                    }
+
+                    const std::size_t index = (static_cast<std::size_t>(bz) * m_brick_count.y + by) * m_brick_count.x + bx;
+                    m_ranges[index] = glm::vec2(static_cast<float>(min_value) / max_value,
+                                                static_cast<float>(max_value_in_brick) / max_value);
+                    const float spread = std::clamp(m_ranges[index].y - m_ranges[index].x, 0.0f, 1.0f);
+                    m_importance[index] = static_cast<uint8_t>(spread * 255.0f + 0.5f);
+                }
+            }
+        }
+    });
+}
+
+#endif
@@ -0,0 +1,63 @@
+#ifndef LOADINGPROGRESS_HPP
+#define LOADINGPROGRESS_HPP
+
+#include <atomic>
+#include <string>
+
+enum class LoadingStage : unsigned int {
+    Idle,
+    Parsing,
+    Reading,
+    Preprocessing,
+    Uploading,
+    Done,
+    Cancelled,
+    Failed,
+};
+
+// Shared between the loader thread (writer) and the GUI thread (reader), so every field is atomic.
+struct LoadingProgress {
+    std::atomic<LoadingStage> stage { LoadingStage::Idle };
+    std::atomic<float> fraction { 0.0f };
+    std::atomic<bool> cancel_requested { false };
+
+    void Reset() {
+        stage = LoadingStage::Idle;
+        fraction = 0.0f;
+        cancel_requested = false;
+    }
+
+    void SetStage(LoadingStage new_stage) {
+        stage = new_stage;
+        fraction = 0.0f;
+    }
+
+    bool IsCancelled() const {
+        return cancel_requested.load(std::memory_order_relaxed);
+    }
+
+    const char* ShowStage() const {
+        switch (stage.load()) {
+            case LoadingStage::Idle:
+                return "Idle";
+            case LoadingStage::Parsing:
+                return "Parsing info file";
+            case LoadingStage::Reading:
+                return "Reading raw data";
+            case LoadingStage::Preprocessing:
+                return "Computing gradients and packing texels";
+            case LoadingStage::Uploading:
+                return "Uploading to GPU";
+            case LoadingStage::Done:
+                return "Done";
+            case LoadingStage::Cancelled:
+                return "Cancelled";
+            case LoadingStage::Failed:
+                return "Failed";
+            default:
+                return "";
+        }
+    }
+};
+
+#endif
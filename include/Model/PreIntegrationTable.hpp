@@ -0,0 +1,29 @@
+#ifndef PREINTEGRATIONTABLE_HPP
+#define PREINTEGRATIONTABLE_HPP
+
+#include <chrono>
+#include <vector>
+
+/**
+ * Pre-integrated transfer function: the color and opacity of a ray segment from the front value to the back value.
+ *
+ * 逐點分類在取樣間距大的時候會漏掉很窄的特徵，pre-integration 則是把一段 segment 內經過的整個數值區間
+ * 都積分起來，所以 volume.frag 用 (front, back) 查表就能在大間距下維持差不多的畫質。
+ * 表格 (i, j) 對應 transfer function 第 i 與第 j 個 texel 的中心，opacity 以原本一個取樣點的間距為準。
+ */
+struct PreIntegrationTable {
+    // Rebuild the RGBA table (size x size texels, size = colormap texels) from an RGBA colormap.
+    void Build(const std::vector<float>& colormap);
+
+    int m_size = 0;
+    // Row-major, the front value picks the column and the back value the row (texture coordinate (front, back)).
+    std::vector<float> m_texels;
+    std::chrono::duration<double> m_build_cost { 0.0 };
+
+private:
+    // Prefix sums over the texels: extinction and extinction-weighted color, kept between the builds.
+    std::vector<double> m_extinction_sum;
+    std::vector<double> m_color_sum;
+};
+
+#endif
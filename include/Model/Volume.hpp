@@ -4,15 +4,23 @@
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 
+#include <cassert>
 #include <filesystem>
 #include <fstream>
 #include <string>
 #include <vector>
 #include <regex>
 #include <chrono>
+#include <cstdint>
+#include <memory>
+#include <variant>
 
 #include "Geometry/Geometry.hpp"
 #include "Maths/IntegerVector.hpp"
+#include "Model/BrickGrid.hpp"
+#include "Model/LoadingProgress.hpp"
+#include "Model/PreIntegrationTable.hpp"
+#include "Texture/Texture2D.hpp"
 #include "Texture/Texture3D.hpp"
 #include "Texture/Texture1D.hpp"
 #include "GUI/TransferFunctionWidget.hpp"
@@ -29,6 +37,56 @@ enum class SampleType : unsigned int {
     Float
 };
 
+template<typename T>
+struct SampleTag {
+    using type = T;
+};
+
+/**
+ * Call the function with a SampleTag of the C++ type declared by the sample type,
+ * so the caller can be instantiated once per type and get the hot loops specialized at compile time.
+ *
+ * Usage: DispatchSampleType(type, [&](auto tag) { using T = typename decltype(tag)::type; ... });
+ */
+template<typename Function>
+decltype(auto) DispatchSampleType(SampleType sample_type, Function&& function) {
+    switch (sample_type) {
+        case SampleType::UnsignedChar:
+            return function(SampleTag<uint8_t>{});
+        case SampleType::UnsignedShort:
+            return function(SampleTag<uint16_t>{});
+        case SampleType::Short:
+            return function(SampleTag<int16_t>{});
+        case SampleType::Float:
+        default:
+            return function(SampleTag<float>{});
+    }
+}
+
+// Voxels are kept in the sample type declared by the info file instead of widening everything to float.
+using VoxelData = std::variant<std::vector<uint8_t>, std::vector<uint16_t>, std::vector<int16_t>, std::vector<float>>;
+
+enum class RawLoadMethod : unsigned int {
+    Stream,
+    MemoryMapped,
+};
+
+/**
+ * How the voxels are laid out on the GPU.
+ *
+ * PackedFloat:     one RGBA32F texel per voxel (gradient in rgb, normalized value in a), 16 bytes per voxel. The default.
+ * ScalarSnormRGB8: the value in R8/R16/R16_SNORM/R32F (same as the sample type) and the unit normal in RGB8_SNORM.
+ * ScalarOctahedral: the value as above and the unit normal octahedral-encoded in RG16, a zero gradient as the texel (0, 0).
+ *
+ * The compact layouts are opt-in: they filter unit normals instead of the unnormalized gradients,
+ * so the shading is not exactly the same as with PackedFloat.
+ */
+enum class VolumeTextureLayout : unsigned int {
+    PackedFloat,
+    ScalarSnormRGB8,
+    ScalarOctahedral,
+};
+
 struct Volume {
     struct Info {
         std::string info_file_path;
@@ -39,22 +97,51 @@ struct Volume {
         glm::vec3 voxel_size;
         std::string voxel_unit;
     } m_info;
-    std::vector<float> m_data;
-    std::vector<glm::vec3> m_normals;
+    VoxelData m_data;
+    float m_min_value, m_max_value;
+    VolumeTextureLayout m_layout;
+    // Only alive between Initialize() and Upload(), which one is used depends on the layout.
     std::vector<glm::vec4> m_texture_data;
-    Texture3D m_texture;
-    Texture1D m_transfer_texture;
+    std::vector<int8_t> m_normal_snorm;
+    std::vector<uint16_t> m_normal_octahedral;
+    // Scalar (or packed) texture and the normal texture of the compact layouts.
+    std::unique_ptr<Texture3D> m_texture = nullptr;
+    std::unique_ptr<Texture3D> m_normal_texture = nullptr;
+    // Empty space skipping: brick value ranges (built once) and their occupancy under the current transfer function.
+    BrickGrid m_bricks;
+    std::unique_ptr<Texture3D> m_occupancy_texture = nullptr;
+    std::unique_ptr<Texture3D> m_importance_texture = nullptr;
+    std::unique_ptr<Texture1D> m_transfer_texture = nullptr;
+    // Pre-integrated classification, rebuilt with every change of the transfer function.
+    PreIntegrationTable m_preintegration;
+    std::unique_ptr<Texture2D> m_preintegration_texture = nullptr;
 
     GLuint m_vao, m_vbo, m_ebo;
     std::vector<VolumeVertex> m_vertices;
     std::vector<GLuint> m_indices;
 
+    RawLoadMethod m_load_method;
     std::chrono::duration<double> m_loading_cost;
-
-    explicit Volume(const std::string& info_file, const std::string& raw_file = "");
+    std::chrono::duration<double> m_raw_loading_cost;
+    std::chrono::duration<double> m_preprocess_cost;
+    std::chrono::duration<double> m_brick_cost;
+    std::chrono::duration<double> m_upload_cost;
+    std::size_t m_peak_memory;
+    std::size_t m_peak_memory_after_preprocess;
+
+    // Only does the CPU work, so it is safe to construct on a worker thread. Call Upload() on the GL thread afterwards.
+    explicit Volume(const std::string& info_file, const std::string& raw_file = "",
+                    RawLoadMethod load_method = RawLoadMethod::MemoryMapped,
+                    LoadingProgress* progress = nullptr,
+                    VolumeTextureLayout layout = VolumeTextureLayout::PackedFloat);
     ~Volume();
 
     void Initialize();
+    // False when the info or RAW file could not be read, LoadError() tells why. Nothing else of the volume is valid then.
+    bool IsLoaded() const;
+    const std::string& LoadError() const;
+    void Upload();
+    bool IsUploaded() const;
     void Bind() const;
     void UnBind() const;
     void DrawOnly() const;
@@ -63,21 +150,70 @@ struct Volume {
     void GenerateTFTexture(const TransferFunctionWidget& tf_widget);
 
     int GetIndex(const int& i, const int& j, const int& k) const;
-    float GetVoxelVal(const int& i, const int& j, const int& k) const;
+    // The shader multiplies the sampled scalar by this to get value / max value.
+    float GetValueScale() const;
+    std::size_t GetTextureBytes(VolumeTextureLayout layout) const;
+    std::size_t GetVoxelCount() const;
+    std::size_t GetVoxelBytes() const;
+
+    template<typename T>
+    const std::vector<T>& GetVoxels() const {
+        return std::get<std::vector<T>>(m_data);
+    }
+
+    template<typename T>
+    T GetVoxelVal(const int& i, const int& j, const int& k) const {
+        const std::vector<T>& voxels = GetVoxels<T>();
+        const int index = GetIndex(i, j, k);
+        assert(index >= 0 && index < voxels.size());
+        return voxels[index];
+    }
+
     void ShowMe();
     std::string ShowSampleType() const;
     std::string ShowEndianness() const;
+    std::string ShowLoadMethod() const;
+    static std::string ShowLayout(VolumeTextureLayout layout);
 
 protected:
-    void ComputeNormals();
-    void GenerateTextureData();
+    /**
+     * Fused gradient and texel packing, slab by slab: the gradients of a slice only live in a per-thread buffer
+     * and are packed into m_texture_data right away, so there is no volume-sized normal store.
+     */
+    void Preprocess();
+
+    template<typename T>
+    void Preprocess();
+
+    void BuildBricks();
+    void PackNormals(const glm::vec3* normals, std::size_t offset, std::size_t count);
+    void UploadScalarTexture();
     void GenerateVertices();
     void BufferInitialize();
     void Clear();
 
 private:
-    void LoadInfo();
-    void LoadRaw();
+    LoadingProgress* m_progress;
+    std::string m_load_error;
+
+    bool IsCancelled() const;
+    void ReportProgress(LoadingStage stage, float fraction = 0.0f) const;
+
+    // Run on the loader thread: a bad file is reported through Fail(), never by exiting.
+    bool LoadInfo();
+    bool LoadRaw();
+    bool LoadRawFromStream();
+    bool LoadRawFromMapping();
+    bool Fail(const std::string& reason);
+
+    template<typename T>
+    void ConvertSamples(const unsigned char* source, std::size_t count);
+
+    template<typename T>
+    void ReadSamples(std::ifstream& file, std::size_t file_size);
+
+    template<typename T>
+    void SetValueRange(T min_value, T max_value);
 
     /**
      * Network byte order(Big-Endian) convert to host byte order(Little-Endian)
@@ -0,0 +1,64 @@
+#ifndef VOLUMELOADER_HPP
+#define VOLUMELOADER_HPP
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Model/LoadingProgress.hpp"
+#include "Model/Volume.hpp"
+
+/**
+ * Loads a volume on a worker thread so the render loop keeps running.
+ *
+ * 背景執行緒只負責 CPU 的部份（解析、轉換、梯度計算與打包），
+ * OpenGL 的 context 只屬於主執行緒，所以上傳材質的工作留給 TakeResult() 的呼叫者。
+ * Cancel() does not wait for the worker: a cancelled load stops at its next check and is joined by a later TakeResult().
+ */
+struct VolumeLoader {
+    VolumeLoader() = default;
+    ~VolumeLoader();
+
+    VolumeLoader(const VolumeLoader&) = delete;
+    VolumeLoader& operator=(const VolumeLoader&) = delete;
+
+    void Start(const std::string& info_file, VolumeTextureLayout layout = VolumeTextureLayout::PackedFloat);
+    void Cancel();
+    // Cancel and join every worker, before the program exits.
+    void Shutdown();
+    bool IsBusy() const;
+
+    // Polled every frame on the GL thread: the finished volume once, otherwise nullptr.
+    std::unique_ptr<Volume> TakeResult();
+
+    const LoadingProgress& Progress() const;
+    const std::string& CurrentFile() const;
+    // Why the last load failed, empty if it did not.
+    const std::string& LastError() const;
+
+private:
+    // One load, shared with its worker thread. The address stays the same while the worker runs.
+    struct Job {
+        LoadingProgress progress;
+        std::string info_file;
+        std::thread worker;
+        // Written by the worker before finished is set, read only after it
+        std::unique_ptr<Volume> result = nullptr;
+        std::string error;
+        std::atomic<bool> finished { false };
+    };
+
+    static void Work(Job* job, VolumeTextureLayout layout);
+    // Join the cancelled jobs whose worker is done, or every one of them when wait is true.
+    void Retire(bool wait);
+
+    std::unique_ptr<Job> m_job = nullptr;
+    std::vector<std::unique_ptr<Job>> m_cancelled;
+    LoadingProgress m_idle_progress;
+    std::string m_current_file;
+    std::string m_last_error;
+};
+
+#endif
@@ -15,6 +15,8 @@ struct AxesRenderer : public Renderer {
 private:
     BasicShader* m_shader;
     std::unique_ptr<MatrixStack> model = nullptr;
+    UniformHandle m_object_color;
+    UniformHandle m_model;
 
     void DrawAxes(float length);
 };
@@ -0,0 +1,44 @@
+#ifndef BLOOMRENDERER_HPP
+#define BLOOMRENDERER_HPP
+
+#include <glm/glm.hpp>
+
+#include "Geometry/2D/Screen.hpp"
+#include "Texture/Texture2D.hpp"
+#include "Shader/BloomShader.hpp"
+
+/**
+ * Passes of the mip-chain bloom, the caller binds the framebuffer and the viewport of the target level.
+ *
+ * 先把亮部一路縮小一半，再從最小的一層往回放大、疊加到上一層，
+ * 每一層的模糊範圍都加倍，所以 log2 次的 pass 就有很大的模糊半徑。
+ */
+struct BloomRenderer {
+    // Level 0 is half of the scene, every level is half of the one before.
+    static constexpr int MaxLevels = 8;
+
+    BloomRenderer(BloomShader* shader);
+    // The requested depth, limited to MaxLevels and to levels of at least 2x2 texels.
+    static int ChainDepth(int levels, int width, int height);
+    static int LevelWidth(int level, int width);
+    static int LevelHeight(int level, int height);
+
+    // Build both programs ahead of the first frame.
+    void WarmUp();
+    // Filter the next larger level into the bound target, region is the drawn part of the source texture.
+    void Downsample(const Texture2D* source, const glm::vec2& region, const Screen* screen);
+    // Filter the next smaller level and add it onto the bound target (additive blending is set by the caller).
+    void Upsample(const Texture2D* source, const glm::vec2& region, const Screen* screen, float filter_radius);
+
+private:
+    BloomShader* m_shader;
+    const ShaderDefines m_downsample_defines = {};
+    const ShaderDefines m_upsample_defines = { "UPSAMPLE" };
+    // Resolved by WarmUp()
+    VariantHandle m_downsample = -1;
+    VariantHandle m_upsample = -1;
+    UniformHandle m_filter_radius;
+    UniformHandle m_region;
+};
+
+#endif
@@ -0,0 +1,17 @@
+#ifndef CPURENDERBENCHMARK_HPP
+#define CPURENDERBENCHMARK_HPP
+
+#include "Config.hpp"
+
+/**
+ * Headless rendering with CpuVolumeRenderer, no window or OpenGL context is created.
+ *
+ * Usage: volume_renderer --cpu-render [--volume <volume.toml>] [--tf <preset.toml>] [--image <file.png>]
+ *                        [--width W] [--height H] [--scaling]
+ * --scaling renders the same frame with 1, 2, 4, ... up to every hardware thread and reports the rays/sec of each.
+ */
+struct CpuRenderBenchmark {
+    static int Run(const Config& config);
+};
+
+#endif
@@ -0,0 +1,92 @@
+#ifndef CPUVOLUMERENDERER_HPP
+#define CPUVOLUMERENDERER_HPP
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "Maths/GradientKernel.hpp"
+#include "Maths/IntegerVector.hpp"
+#include "Model/Volume.hpp"
+#include "Utility/ThreadPool.hpp"
+
+// Everything the CPU ray caster reads, the defaults are the ones of World and VolumeRenderer.
+struct CpuRenderSettings {
+    int width = 1024;
+    int height = 720;
+
+    glm::vec3 camera_position = glm::vec3(0.0f, 0.0f, 400.0f);
+    glm::vec3 camera_target = glm::vec3(0.0f);
+    glm::vec3 world_up = glm::vec3(0.0f, 1.0f, 0.0f);
+    // Vertical field of view in degrees (Camera::zoom)
+    float fov = 45.0f;
+
+    float sample_rate = 0.5f;
+    bool use_lighting = true;
+    bool use_opacity_correction = false;
+    float opacity_reference_step = 0.5f;
+    float shininess = 256.0f;
+    // The point light follows the camera in the application.
+    glm::vec3 light_position = glm::vec3(0.0f, 0.0f, 400.0f);
+    glm::vec3 light_color = glm::vec3(1.0f);
+    glm::vec3 background_color = glm::vec3(0.01f, 0.01f, 0.01f);
+
+    // The lanes of a packet are traced with AVX2 when the CPU has it, SSE and Scalar use the per-lane loop.
+    Maths::SimdLevel simd_level = Maths::GradientKernel::Level();
+};
+
+/**
+ * Software version of volume.frag: the same ray setup, transfer function lookup, Blinn-Phong shading,
+ * front-to-back compositing and early termination, for machines without a GPU and as a reference for the shader.
+ *
+ * 影像切成 TileSize x TileSize 的 tile 交給 WorkStealingScheduler，tile 內每 PacketWidth x PacketHeight 個像素
+ * 組成一個 ray packet，以 SoA 的方式一起前進。AVX2 的版本一次處理 8 條 ray：取樣用 gather，
+ * 已經結束的 ray 以 mask 保留原值而不是跳過；只有 pow() 仍然逐條計算。
+ */
+struct CpuVolumeRenderer {
+    static constexpr int TileSize = 16;
+    static constexpr int PacketWidth = 4;
+    static constexpr int PacketHeight = 2;
+    static constexpr int PacketSize = PacketWidth * PacketHeight;
+
+    struct Statistics {
+        double seconds = 0.0;
+        std::size_t rays = 0;
+        std::size_t samples = 0;
+        std::size_t tiles = 0;
+        std::size_t steals = 0;
+
+        double RaysPerSecond() const;
+    };
+
+    // colormap: RGBA of the transfer function (TransferFunctionWidget::GetColorData())
+    CpuVolumeRenderer(const Volume& volume, const std::vector<float>& colormap);
+
+    // The image is RGBA, row-major from the top row, the output of the volume pass before the screen pass.
+    Statistics Render(const CpuRenderSettings& settings, ThreadPool& pool, std::vector<glm::vec4>& image) const;
+
+    static bool WritePNG(const std::string& file_path, const std::vector<glm::vec4>& image, int width, int height);
+
+private:
+    struct RayPacket;
+
+    float SampleValue(const glm::vec3& position) const;
+    glm::vec3 SampleNormal(const glm::vec3& position) const;
+    glm::vec4 Classify(float value) const;
+    glm::vec3 BlinnPhongShading(const glm::vec3& normal, const glm::vec3& color, const glm::vec3& position,
+                                const CpuRenderSettings& settings) const;
+    std::size_t TracePacket(RayPacket& packet, const CpuRenderSettings& settings) const;
+    std::size_t TracePacketAVX2(RayPacket& packet, const CpuRenderSettings& settings) const;
+    // Whether the AVX2 lanes can be used for the settings and this volume (32-bit gather indices).
+    bool UsesAVX2(const CpuRenderSettings& settings) const;
+
+    Maths::ivec3 m_resolution;
+    glm::vec3 m_actual_resolution;
+    // Normalized voxel values (value / max value), what SampleValue() in volume.frag returns
+    std::vector<float> m_values;
+    std::vector<float> m_colormap;
+};
+
+#endif
@@ -0,0 +1,93 @@
+#ifndef FRAMEGRAPH_HPP
+#define FRAMEGRAPH_HPP
+
+#include <functional>
+#include <initializer_list>
+#include <vector>
+
+#include "GL/FrameBuffer.hpp"
+#include "GL/RenderTargetPool.hpp"
+
+// The parts of a frame the graph is executed in, Application times each of them on its own.
+enum class FrameStage : unsigned int {
+    Scene,
+    Bloom,
+    Screen,
+};
+
+using FrameResource = int;
+
+/**
+ * The post processing passes of a frame with the targets they read and write.
+ *
+ * 每個 pass 宣告讀寫哪些 target，Compile() 由後往前把沒有人讀的 pass 剔除（side effect 的 pass 除外），
+ * 剩下的 transient target 在第一個用到它的 pass 之前才向 RenderTargetPool 取得、最後一個用到之後立刻歸還，
+ * 所以壽命不重疊的 target 會拿到同一份 storage。
+ * The graph is built and compiled only when its structure changes, Execute() itself does not allocate.
+ */
+struct FrameGraph {
+    // Drop the passes and resources, the transient targets still held go back to the pool.
+    void Clear();
+
+    // A persistent target owned by the caller, read through the pointer when a pass runs.
+    FrameResource Import(const char* name, const RenderTarget* target);
+    // A target of width x height from the pool, held only while a pass uses it.
+    // A retained one is kept after its last reader until the first pass of the graph runs again, for frames which only redraw the screen.
+    FrameResource Create(const char* name, int width, int height, bool retained = false);
+    // A new size for a created resource, the graph is not rebuilt. A retained target it still holds is given back.
+    void Resize(FrameResource resource, int width, int height);
+    // A pass with side effects (the default framebuffer, a read back) is never culled.
+    void AddPass(const char* name, FrameStage stage, std::initializer_list<FrameResource> reads, std::initializer_list<FrameResource> writes,
+                 std::function<void()> execute, bool side_effect = false);
+
+    // Cull the passes and find the first and last use of every resource.
+    void Compile();
+    // The live passes of the stage in the order they were added.
+    void Execute(FrameStage stage);
+
+    // Whether a live pass reads the resource, only those get a target.
+    bool IsRealized(FrameResource resource) const;
+    // Valid from the first until the last pass which uses the resource.
+    const RenderTarget& Target(FrameResource resource) const;
+    TextureHandle Texture(FrameResource resource) const;
+    FrameBuffer& Framebuffer(FrameResource resource);
+
+    // After Compile(), for the GUI
+    int PassCount() const;
+    int LivePassCount() const;
+
+private:
+    struct Resource {
+        // A string literal, the name is not copied.
+        const char* name;
+        const RenderTarget* imported;
+        int width;
+        int height;
+        bool retained;
+        // Compiled
+        int first_pass;
+        int last_pass;
+        int readers;
+        TransientTarget target;
+    };
+
+    struct Pass {
+        const char* name;
+        FrameStage stage;
+        std::vector<FrameResource> reads;
+        std::vector<FrameResource> writes;
+        std::function<void()> execute;
+        bool side_effect;
+        // Compiled
+        bool live;
+    };
+
+    void Acquire(Resource& resource);
+    void Release(Resource& resource);
+
+    std::vector<Resource> m_resources;
+    std::vector<Pass> m_passes;
+    int m_first_live_pass = -1;
+};
+
+#endif
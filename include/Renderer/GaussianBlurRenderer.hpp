@@ -1,6 +1,8 @@
 #ifndef GAUSSIANBLURRENDERER_HPP
 #define GAUSSIANBLURRENDERER_HPP
 
+#include <glm/glm.hpp>
+
 #include "Geometry/2D/Screen.hpp"
 #include "Texture/Texture2D.hpp"
 #include "Shader/GaussianBlurShader.hpp"
@@ -8,11 +10,13 @@
 struct GaussianBlurRenderer {
     GaussianBlurRenderer(GaussianBlurShader* shader);
     void Prepare(bool is_horizontal);
-    void Render(const Texture2D* image, const Screen* screen);
+    // region: the part of the image texture which was drawn, in texture coordinates
+    void Render(const Texture2D* image, const glm::vec2& region, const Screen* screen);
 
 private:
     GaussianBlurShader* m_shader;
-
+    UniformHandle m_is_horizontal;
+    UniformHandle m_region;
 };
 
 #endif
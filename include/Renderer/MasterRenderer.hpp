@@ -6,15 +6,21 @@
 
 #include "Camera.hpp"
 
+#include "GL/RenderTargetPool.hpp"
+#include "GL/UniformBuffer.hpp"
+#include "Shader/UniformBlocks.hpp"
+
 #include "Shader/BasicShader.hpp"
 #include "Shader/ScreenShader.hpp"
 #include "Shader/GaussianBlurShader.hpp"
 #include "Shader/VolumeShader.hpp"
+#include "Shader/BloomShader.hpp"
 
 #include "Renderer/AxesRenderer.hpp"
 #include "Renderer/ScreenRenderer.hpp"
 #include "Renderer/GaussianBlurRenderer.hpp"
 #include "Renderer/VolumeRenderer.hpp"
+#include "Renderer/BloomRenderer.hpp"
 
 #include "World/Entity.hpp"
 
@@ -22,11 +28,24 @@ struct MasterRenderer {
     MasterRenderer();
 
     void Initialize();
+    // Build the programs of the current settings before the first frame, the time shows whether the binary cache was warm.
+    void WarmUp();
+    // Upload FrameData (camera and light) for the view, once before the passes which draw it.
+    void PrepareFrame(const std::unique_ptr<Camera>& camera);
     void Render(const std::unique_ptr<Camera>& camera);
+    // The two halves of Render(), the volume may go to a reduced target while the axes stay at full resolution.
+    void RenderVolume(const std::unique_ptr<Camera>& camera);
+    void RenderAxes(const std::unique_ptr<Camera>& camera);
     void Destroy();
 
-    void GaussianBlur(bool is_horizontal, bool first_iteration);
-    void RenderScreen();
+    // The passes draw into the bound framebuffer, the caller sets the viewport to the drawn part of the target.
+    void GaussianBlur(bool is_horizontal, const RenderTarget& source);
+    // A level of the mip chain from the next larger one (level 0 from the bloom attachment)
+    void BloomDownsample(const RenderTarget& source);
+    // Add the next smaller level onto the bound one
+    void BloomUpsample(const RenderTarget& source);
+    // bloom is nullptr when the bloom is off
+    void RenderScreen(const RenderTarget& scene, const RenderTarget* bloom);
 
 private:
     // Shaders
@@ -34,12 +53,17 @@ private:
     std::unique_ptr<ScreenShader> screen_shader = nullptr;
     std::unique_ptr<GaussianBlurShader> gaussian_blur_shader = nullptr;
     std::unique_ptr<VolumeShader> volume_shader = nullptr;
+    std::unique_ptr<BloomShader> bloom_shader = nullptr;
 
     // Renderers
     std::unique_ptr<AxesRenderer> axes_renderer = nullptr;
     std::unique_ptr<ScreenRenderer> screen_renderer = nullptr;
     std::unique_ptr<GaussianBlurRenderer> gaussian_blur_renderer = nullptr;
     std::unique_ptr<VolumeRenderer> volume_renderer = nullptr;
+    std::unique_ptr<BloomRenderer> bloom_renderer = nullptr;
+
+    FrameUniforms frame_uniforms {};
+    std::unique_ptr<UniformBuffer> frame_uniform_buffer = nullptr;
 };
 
 #endif
\ No newline at end of file
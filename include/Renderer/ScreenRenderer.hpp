@@ -1,17 +1,36 @@
 #ifndef SCREENRENDERER_HPP
 #define SCREENRENDERER_HPP
 
+#include <cstdint>
+#include <unordered_map>
+
+#include <glm/glm.hpp>
+
 #include "Geometry/2D/Screen.hpp"
 #include "Texture/Texture2D.hpp"
 #include "Shader/ScreenShader.hpp"
 
 struct ScreenRenderer {
     ScreenRenderer(ScreenShader* shader);
-    void Prepare();
-    void Render(const Texture2D* screen_texture, const Texture2D* bloom_texture, const Screen* screen);
+    // Pick the shader permutation for the settings of World, Prepare() does it as well.
+    void SelectVariant();
+    // The size of the rendered scene, the depth of the bloom mip chain follows it.
+    void Prepare(int width, int height);
+    // The regions are the drawn parts of the textures, in texture coordinates. bloom_texture is nullptr when the bloom is off.
+    void Render(const Texture2D* screen_texture, const glm::vec2& screen_region, const Texture2D* bloom_texture, const glm::vec2& bloom_region,
+                const Screen* screen);
 
 private:
     ScreenShader* m_shader;
+    ShaderDefines m_defines;
+    // Keyed by the screen mode and the switches of World
+    std::unordered_map<std::uint32_t, VariantHandle> m_variants;
+
+    UniformHandle m_bloom_intensity;
+    UniformHandle m_gamma_value;
+    UniformHandle m_hdr_exposure;
+    UniformHandle m_screen_region;
+    UniformHandle m_bloom_region;
 };
 
 #endif
@@ -1,19 +1,33 @@
 #ifndef VOLUMERENDERER_HPP
 #define VOLUMERENDERER_HPP
 
+#include <cstdint>
+#include <unordered_map>
+
 #include "Camera.hpp"
+#include "GL/UniformBuffer.hpp"
 #include "Renderer/Renderer.hpp"
+#include "Shader/UniformBlocks.hpp"
 #include "Shader/VolumeShader.hpp"
 #include "Model/Volume.hpp"
 
 struct VolumeRenderer : public Renderer {
     VolumeRenderer(VolumeShader* shader);
+    // Pick the shader permutation for the settings of World and the layout of the volume, before Prepare().
+    void SelectVariant(VolumeTextureLayout layout);
     void Prepare(const std::unique_ptr<Camera>& camera) override;
+    // Everything the shader reads besides the textures goes into the VolumeData block with one upload.
     void Render(const Volume* volume);
 
 private:
     VolumeShader* m_shader;
+    ShaderDefines m_defines;
+    // Keyed by the layout and the switches of World, the defines are only built the first time.
+    std::unordered_map<std::uint32_t, VariantHandle> m_variants;
+    glm::vec3 m_camera_position;
 
+    VolumeUniforms m_uniforms {};
+    std::unique_ptr<UniformBuffer> m_uniform_buffer = nullptr;
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,15 @@
+#ifndef BLOOMSHADER_HPP
+#define BLOOMSHADER_HPP
+
+#include "Shader.hpp"
+
+struct BloomShader : public Shader {
+    BloomShader();
+
+private:
+    static const std::string VERTEX_FILE;
+    static const std::string FRAGMENT_FILE;
+
+};
+
+#endif
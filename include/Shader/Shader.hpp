@@ -8,8 +8,8 @@
 #include <string>
 #include <memory>
 #include <unordered_map>
-
-#include "Camera.hpp"
+#include <utility>
+#include <vector>
 
 enum ShaderType : GLenum {
     Vert = GL_VERTEX_SHADER,
@@ -20,13 +20,53 @@ enum ShaderType : GLenum {
     Comp = GL_COMPUTE_SHADER,
 };
 
+// One #define per entry, "NAME" or "NAME VALUE", inserted right after the #version line of every stage.
+using ShaderDefines = std::vector<std::string>;
+// Index of a permutation, from GetVariant()
+using VariantHandle = int;
+// Index of a uniform, from RegisterUniform(), valid in every permutation
+using UniformHandle = int;
+
+/**
+ * A program per permutation of #defines.
+ *
+ * The sources are read once, each permutation is compiled the first time SelectVariant() asks for it and then
+ * cached by its defines, so switching a setting back and forth only switches the program.
+ * 在 shader 裡用 #ifdef 取代 uniform bool 的分支，迴圈裡就只剩下真的有開啟的部份。
+ *
+ * Uniforms set every frame go through handles: the name is registered once and its location is looked up when each
+ * permutation is linked, so the render loop only indexes a vector. Samplers and uniform blocks never change and are
+ * bound once per permutation, right after it is linked.
+ */
 struct Shader {
     Shader(const std::string& vertex_path, const std::string& fragment_path, const std::string& geometry_path = "");
 
-    void Start() const;
+    // Compile the permutation if needed, the handle stays valid for the lifetime of the shader.
+    // A permutation which fails to compile or link is logged and gets the handle of the current one (or the one without defines).
+    VariantHandle GetVariant(const ShaderDefines& defines);
+    // Make the permutation current, call it before Start().
+    void UseVariant(VariantHandle variant);
+    void SelectVariant(const ShaderDefines& defines);
+    std::size_t GetVariantCount() const;
+
+    // Without a SelectVariant() before, the permutation without any define is used.
+    void Start();
     void Stop() const;
     void Destroy() const;
 
+    // A uniform which is compiled out of a permutation has the location -1 there, which OpenGL ignores.
+    UniformHandle RegisterUniform(const std::string& uniform_name);
+    // Applied to every permutation once it is linked.
+    void BindSampler(const std::string& sampler_name, int texture_unit);
+    void BindUniformBlock(const std::string& block_name, GLuint binding);
+
+    void SetInt(UniformHandle uniform, int value);
+    void SetBool(UniformHandle uniform, bool value);
+    void SetFloat(UniformHandle uniform, float value);
+    void SetVec2(UniformHandle uniform, const glm::vec2& vector);
+    void SetVec3(UniformHandle uniform, const glm::vec3& vector);
+    void SetMat4(UniformHandle uniform, const glm::mat4& matrix);
+
     void SetInt(const std::string& uniform_name, int value);
     void SetBool(const std::string& uniform_name, bool value);
     void SetFloat(const std::string& uniform_name, float value);
@@ -35,22 +75,53 @@ struct Shader {
     void SetVec4(const std::string& uniform_name, const glm::vec4& vector);
     void SetMat4(const std::string& uniform_name, const glm::mat4& matrix);
 
-    void SetViewAndProj(const std::unique_ptr<Camera>& camera);
-
 protected:
-    GLuint id;
-    std::unordered_map<std::string, GLint> uniform_location_cache;
+    // The program of the current permutation
+    GLuint id = 0;
 
     GLint GetUniformLocation(const std::string& uniform_name);
 
 private:
-    GLuint vertex_id;
-    GLuint fragment_id;
-    GLuint geometry_id;
+    struct Variant {
+        GLuint id = 0;
+        GLuint vertex_id = 0;
+        GLuint fragment_id = 0;
+        GLuint geometry_id = 0;
+        // Locations differ between the programs, so every permutation has its own cache.
+        std::unordered_map<std::string, GLint> uniform_location_cache;
+        // Indexed by UniformHandle
+        std::vector<GLint> locations;
+    };
+
+    std::string m_vertex_path;
+    std::string m_fragment_path;
+    std::string m_geometry_path;
+    std::string m_vertex_source;
+    std::string m_fragment_source;
+    std::string m_geometry_source;
+
+    // Indexed by VariantHandle, keyed by the defines joined with '\n'
+    std::vector<Variant> m_variants;
+    std::unordered_map<std::string, VariantHandle> m_variant_handles;
+    int m_current = -1;
+    std::string m_key;
+
+    std::vector<std::string> m_uniform_names;
+    std::vector<std::pair<std::string, int>> m_samplers;
+    std::vector<std::pair<std::string, GLuint>> m_uniform_blocks;
+
+    static std::string ReadSource(const std::string& shader_filepath);
+    static std::string InsertDefines(const std::string& source, const ShaderDefines& defines);
+
+    static std::string VariantName(const ShaderDefines& defines);
 
-    GLuint CreateShader(const std::string& shader_filepath, ShaderType shader_type);
+    // A variant with the id 0 when a stage does not compile or the program does not link
+    Variant CreateVariant(const ShaderDefines& defines);
+    static void DeleteVariant(const Variant& variant);
+    void BindResources(Variant& variant) const;
+    GLuint CreateShader(const std::string& source, const std::string& shader_filepath, ShaderType shader_type);
     GLboolean CompileShader(const GLuint& shader_id);
-    GLboolean LinkShaderProgram();
+    GLboolean LinkShaderProgram(const GLuint& program_id);
 };
 
-#endif
\ No newline at end of file
+#endif
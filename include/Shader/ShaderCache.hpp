@@ -0,0 +1,36 @@
+#ifndef SHADERCACHE_HPP
+#define SHADERCACHE_HPP
+
+#include <glad/glad.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Linked program binaries on disk (glGetProgramBinary / glProgramBinary), one file per program.
+ *
+ * The key hashes the final source of every stage (with the defines) and the vendor, renderer and version strings of the
+ * driver, a driver update or an edited shader simply misses. 驅動程式拒絕讀回的 binary 會被刪掉，改回從原始碼編譯。
+ * GL 4.1 / ARB_get_program_binary, without it (or without any binary format) the cache stays disabled.
+ */
+struct ShaderCache {
+    // Call once the OpenGL context is current, an empty directory disables the cache.
+    static void Initialize(const std::string& directory);
+    static bool IsEnabled();
+
+    static std::uint64_t Key(const std::vector<std::string>& sources);
+
+    // A linked program, or 0 on a miss.
+    static GLuint Load(std::uint64_t key);
+    // The program must have been linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT.
+    static void Store(std::uint64_t key, GLuint program);
+
+    static int Hits();
+    static int Misses();
+
+private:
+    static std::string FilePath(std::uint64_t key);
+};
+
+#endif
@@ -0,0 +1,51 @@
+#ifndef UNIFORMBLOCKS_HPP
+#define UNIFORMBLOCKS_HPP
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+
+/**
+ * The C++ side of the std140 uniform blocks declared in the shaders, member by member.
+ *
+ * std140 把 vec3 對齊到 16 bytes，後面接一個 float 剛好補滿，所以每個 vec3 後面都跟著一個 float (或 padding)。
+ * 改了這裡就要一起改 shader 裡的宣告。
+ */
+
+// "FrameData" in basic.vert/frag and volume.vert/frag, written by MasterRenderer once per view
+struct FrameUniforms {
+    static constexpr unsigned int Binding = 0;
+
+    glm::mat4 view;
+    glm::mat4 projection;
+    glm::vec3 view_position;
+    float bloom_threshold;
+    glm::vec3 light_position;
+    float padding0;
+    glm::vec3 light_color;
+    float padding1;
+};
+
+// "VolumeData" in volume.vert/frag, written by VolumeRenderer once per draw
+struct VolumeUniforms {
+    static constexpr unsigned int Binding = 1;
+
+    glm::mat4 model;
+    glm::vec3 volume_resolution;
+    float sample_rate;
+    glm::vec3 volume_ratio;
+    float value_scale;
+    glm::vec3 camera_in_texture;
+    float brick_size;
+    glm::vec3 background_color;
+    float reference_step;
+    float max_step_scale;
+    float importance_threshold;
+    float shininess;
+    float padding0;
+};
+
+static_assert(sizeof(FrameUniforms) == 176 && offsetof(FrameUniforms, light_color) == 160, "FrameUniforms must match the std140 layout of FrameData");
+static_assert(sizeof(VolumeUniforms) == 144 && offsetof(VolumeUniforms, max_step_scale) == 128, "VolumeUniforms must match the std140 layout of VolumeData");
+
+#endif
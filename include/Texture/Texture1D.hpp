@@ -12,11 +12,14 @@ struct Texture1D {
     void UnBind() const;
     void Destroy() const;
     void Generate(GLint internal_format, GLenum format, int image_width, const float* data);
+    // Overwrite the texels [offset, offset + width) of the storage made by Generate(), no reallocation.
+    void Update(GLenum format, int offset, int width, const float* data) const;
 
     void SetWrapParameters(GLint wrap_s) const;
     void SetFilterParameters(GLint min_filter, GLint mag_filter) const;
 
     unsigned int m_id;
+    int m_width;
 };
 
 #endif
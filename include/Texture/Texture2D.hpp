@@ -12,6 +12,9 @@ struct Texture2D {
     void UnBind() const;
     void Destroy() const;
     void Generate(GLint internal_format, GLenum format, int image_width,int image_height, unsigned char* image, bool enable_mipmap = true);
+    // Float texels (e.g. lookup tables), no mipmaps, clamped and linearly filtered.
+    void Generate(GLint internal_format, GLenum format, int image_width, int image_height, const float* data);
+    void Update(GLenum format, int image_width, int image_height, const float* data) const;
 
     void SetWrapParameters(GLint wrap_s, GLint wrap_t) const;
     void SetFilterParameters(GLint min_filter, GLint mag_filter) const;
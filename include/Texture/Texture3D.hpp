@@ -11,7 +11,9 @@ struct Texture3D {
     void Bind() const;
     void UnBind() const;
     void Destroy() const;
-    void Generate(GLint internal_format, GLenum format, int width, int height, int depth, const float* data);
+    void Generate(GLint internal_format, GLenum format, GLenum type, int width, int height, int depth, const void* data);
+    // Overwrite the whole storage made by Generate() with the same size, no reallocation.
+    void Update(GLenum format, GLenum type, int width, int height, int depth, const void* data) const;
 
     void SetWrapParameters(GLint wrap_s, GLint wrap_t, GLint wrap_r) const;
     void SetFilterParameters(GLint min_filter, GLint mag_filter) const;
@@ -4,32 +4,146 @@
 #include <SDL.h>
 #include <glad/glad.h>
 
+#include <cstddef>
+#include <cstdint>
 #include <map>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "Texture/Texture2D.hpp"
 #include "Texture/CubeMap.hpp"
+#include "Utility/Logger.hpp"
+
+/**
+ * A slot of the TextureManager plus the generation of the slot when the handle was made.
+ *
+ * Releasing a texture gives its slot a new generation, so a handle kept past the release is caught
+ * instead of reading whatever texture took the slot afterwards.
+ */
+template<typename T>
+struct ResourceHandle {
+    static constexpr std::uint32_t InvalidIndex = 0xFFFFFFFFu;
+
+    std::uint32_t index = InvalidIndex;
+    std::uint32_t generation = 0;
+
+    bool IsValid() const { return index != InvalidIndex; }
+};
+
+using TextureHandle = ResourceHandle<Texture2D>;
+using CubeMapHandle = ResourceHandle<CubeMap>;
+
+enum class TextureKind : unsigned int {
+    TEXTURE_2D,
+    RENDER_TARGET,
+    CUBE_MAP
+};
+
+// What the registry knows about a slot, for reporting.
+struct TextureInfo {
+    std::string name;
+    TextureKind kind = TextureKind::TEXTURE_2D;
+    int width = 0;
+    int height = 0;
+    GLint internal_format = 0;
+    // The storage of every face and mipmap level, as the driver is asked for it (padding not included).
+    std::size_t bytes = 0;
+    std::uint32_t generation = 0;
+    bool alive = false;
+};
+
+/**
+ * Dense slots of one resource type, a handle is an index into them.
+ *
+ * 名字只在 setup 的時候查一次（std::map），之後每個 frame 都是用 handle 直接存取陣列。
+ */
+template<typename T>
+struct ResourceRegistry {
+    std::vector<T> resources;
+    std::vector<TextureInfo> infos;
+    std::vector<std::uint32_t> free_slots;
+    std::map<std::string, ResourceHandle<T>> names;
+
+    ResourceHandle<T> Add(const T& resource, TextureInfo info) {
+        std::uint32_t index;
+        if (free_slots.empty()) {
+            index = static_cast<std::uint32_t>(resources.size());
+            resources.push_back(resource);
+            infos.emplace_back();
+        } else {
+            index = free_slots.back();
+            free_slots.pop_back();
+            resources[index] = resource;
+        }
+
+        info.generation = infos[index].generation;
+        info.alive = true;
+        infos[index] = std::move(info);
+
+        // A name keeps referring to the first live resource registered with it, a later one is only reachable by its handle.
+        const ResourceHandle<T> handle { index, infos[index].generation };
+        if (!names.emplace(infos[index].name, handle).second) {
+            Logger::Message(LogLevel::Warning, "<" + infos[index].name + "> is already registered, the new resource can not be found by name.");
+        }
+        return handle;
+    }
+
+    bool Contains(ResourceHandle<T> handle) const {
+        return handle.index < infos.size() && infos[handle.index].alive && infos[handle.index].generation == handle.generation;
+    }
+
+    void Remove(ResourceHandle<T> handle) {
+        TextureInfo& info = infos[handle.index];
+        const auto it = names.find(info.name);
+        if (it != names.end() && it->second.index == handle.index && it->second.generation == handle.generation) {
+            names.erase(it);
+        }
+        info.alive = false;
+        info.bytes = 0;
+        info.generation++;
+        free_slots.push_back(handle.index);
+    }
+};
 
 class TextureManager {
 public:
-    static std::map<std::string, Texture2D> texture2Ds;
-    static std::map<std::string, CubeMap> cubemaps;
-
     static void Initialize();
     static void Destroy();
 
-    static Texture2D &CreateTexture2D(const std::string &file_name, const std::string &texture_name, bool is_srgb = false, bool is_flip = true);
-    static Texture2D &CreateTexture2D(const int width, const int height, const std::string &texture_name);
-    static Texture2D &GetTexture2D(const std::string &texture_name);
+    // Setup: create or look up by name, keep the handle
+    static TextureHandle CreateTexture2D(const std::string &file_name, const std::string &texture_name, bool is_srgb = false, bool is_flip = true);
+    // An RGB16F color attachment without mipmaps, linear and clamped.
+    static TextureHandle CreateRenderTarget(const int width, const int height, const std::string &texture_name);
+    static TextureHandle FindTexture2D(const std::string &texture_name);
+    static CubeMapHandle CreateCubeMap(const std::vector<std::string> &file_names, const std::string &texture_name, bool is_srgb = false);
+    static CubeMapHandle FindCubeMap(const std::string &texture_name);
 
-    static CubeMap &CreateCubeMap(const std::vector<std::string> &file_names, const std::string &texture_name, bool is_srgb = false);
-    static CubeMap &GetCubeMap(const std::string &texture_name);
+    // Per frame: an array index, exits on a released or foreign handle
+    static Texture2D &GetTexture2D(TextureHandle handle);
+    static CubeMap &GetCubeMap(CubeMapHandle handle);
 
+    // New storage for the render target, the handle and the texture object stay the same.
+    static void ResizeRenderTarget(TextureHandle handle, const int width, const int height);
+    // Delete the texture, the handle (and every copy of it) is invalid afterwards.
+    static void Release(TextureHandle handle);
+    static void Release(CubeMapHandle handle);
+
+    static const TextureInfo &GetTextureInfo(TextureHandle handle);
+    // Every slot including the released ones (alive == false)
+    static const std::vector<TextureInfo> &GetTextureInfos();
+    static const std::vector<TextureInfo> &GetCubeMapInfos();
+    // Sum over the live resources of the kind
+    static std::size_t GetGPUBytes(TextureKind kind);
+    static std::size_t GetGPUBytes();
 
 private:
     TextureManager() = default;
-    static Texture2D LoadTexture2DFromFile(const std::string &file_path, bool is_srgb, bool is_flip);
-    static CubeMap LoadCubeMapFromFile(const std::vector<std::string> &file_path, bool is_srgb);
+    static Texture2D LoadTexture2DFromFile(const std::string &file_path, bool is_srgb, bool is_flip, TextureInfo &info);
+    static CubeMap LoadCubeMapFromFile(const std::vector<std::string> &file_path, bool is_srgb, TextureInfo &info);
+
+    static ResourceRegistry<Texture2D> texture2Ds;
+    static ResourceRegistry<CubeMap> cubemaps;
 };
 
 #endif
@@ -0,0 +1,39 @@
+#ifndef ALLOCATIONCOUNTER_HPP
+#define ALLOCATIONCOUNTER_HPP
+
+#include <cstdint>
+
+/**
+ * Counts the calls of the global operator new, summed over all threads.
+ *
+ * Only built with -DVOLUME_RENDERER_COUNT_ALLOCATIONS=ON, which replaces operator new/delete; otherwise every
+ * count stays 0. 用兩次 Current() 的差就知道中間那段程式配置了幾次記憶體。
+ */
+struct AllocationCounter {
+    struct Totals {
+        std::uint64_t count = 0;
+        std::uint64_t bytes = 0;
+
+        Totals operator-(const Totals& other) const {
+            return { count - other.count, bytes - other.bytes };
+        }
+        Totals& operator+=(const Totals& other) {
+            count += other.count;
+            bytes += other.bytes;
+            return *this;
+        }
+    };
+
+    static bool IsEnabled();
+    // Since the start of the program
+    static Totals Current();
+
+    // Called once at the end of every frame of the main loop (main thread only).
+    static void EndFrame();
+    // Between the last two EndFrame()
+    static Totals LastFrame();
+    // Frames which allocated anything, a steady state loop keeps this number still.
+    static std::uint64_t AllocatingFrames();
+};
+
+#endif
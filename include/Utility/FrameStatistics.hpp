@@ -0,0 +1,30 @@
+#ifndef FRAMESTATISTICS_HPP
+#define FRAMESTATISTICS_HPP
+
+#include <string>
+#include <vector>
+
+/**
+ * Per-frame timings in named columns (milliseconds), written as CSV with p50/p95/p99 summaries.
+ */
+struct FrameStatistics {
+    explicit FrameStatistics(std::vector<std::string> columns);
+
+    // One value per column, in the order of the columns.
+    void AddFrame(const std::vector<double>& values);
+    std::size_t FrameCount() const;
+
+    // Nearest-rank percentile of a column, p in [0, 100].
+    double Percentile(std::size_t column, double p) const;
+    double Mean(std::size_t column) const;
+
+    // Every frame to `file_path`, the summary to "<file_path without extension>_summary.csv".
+    bool WriteCSV(const std::string& file_path) const;
+    void LogSummary() const;
+
+private:
+    std::vector<std::string> m_columns;
+    std::vector<std::vector<double>> m_frames;
+};
+
+#endif
@@ -3,6 +3,7 @@
 
 #include <glm/glm.hpp>
 #include <stack>
+#include <vector>
 
 struct MatrixStack {
     MatrixStack();
@@ -14,7 +15,8 @@ struct MatrixStack {
     glm::mat4 Top() const;
 
 private:
-    std::stack<glm::mat4> stack;
+    // A vector keeps its capacity when popped, the default std::deque frees and allocates its blocks.
+    std::stack<glm::mat4, std::vector<glm::mat4>> stack;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,38 @@
+#ifndef MEMORYMAPPEDFILE_HPP
+#define MEMORYMAPPEDFILE_HPP
+
+#include <cstddef>
+#include <string>
+
+/**
+ * A read-only view of a whole file mapped into the address space.
+ *
+ * 檔案內容不會先複製到 user-space 的 buffer，而是直接由 OS 依照存取的 page 載入，
+ * 所以可以從 Data() 直接轉換到最終的資料結構中，避免多餘的複製。
+ */
+struct MemoryMappedFile {
+    explicit MemoryMappedFile(const std::string& file_path);
+    ~MemoryMappedFile();
+
+    MemoryMappedFile(const MemoryMappedFile&) = delete;
+    MemoryMappedFile& operator=(const MemoryMappedFile&) = delete;
+
+    bool IsOpen() const;
+    const unsigned char* Data() const;
+    std::size_t Size() const;
+
+    void Close();
+
+private:
+    const unsigned char* m_data;
+    std::size_t m_size;
+
+#if defined(_WIN32)
+    void* m_file_handle;
+    void* m_mapping_handle;
+#else
+    int m_file_descriptor;
+#endif
+};
+
+#endif
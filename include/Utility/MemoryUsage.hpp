@@ -0,0 +1,16 @@
+#ifndef MEMORYUSAGE_HPP
+#define MEMORYUSAGE_HPP
+
+#include <cstddef>
+#include <string>
+
+struct MemoryUsage {
+    // The peak resident set size (high-water mark) of the current process in bytes, 0 if unknown.
+    static std::size_t PeakResidentBytes();
+
+    static std::string FormatBytes(std::size_t bytes);
+    // The same text written into buffer, for the GUI which shows it every frame.
+    static void FormatBytes(std::size_t bytes, char* buffer, std::size_t buffer_size);
+};
+
+#endif
@@ -0,0 +1,119 @@
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+
+#include <glad/glad.h>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+/**
+ * Scoped CPU timers and GL_TIME_ELAPSED queries per frame, kept in a rolling history for the profiler panel.
+ *
+ * GPU 的結果晚 FramesInFlight 個 frame 才讀，所以 query 分成三組輪流使用，讀的時候 GPU 通常早就做完了；
+ * 讀之前仍會檢查 GL_QUERY_RESULT_AVAILABLE，還沒好的 scope 就當作這個 frame 沒有 GPU 時間，不會讓 CPU 等 GPU。
+ * GL_TIME_ELAPSED 不能巢狀：已經有 scope 在 GPU 計時的時候，裡面的 scope 只量 CPU 時間。
+ * The benchmark times its passes with TimerQuery, so the profiler is not recording there.
+ */
+struct Profiler {
+    static constexpr int FramesInFlight = 3;
+    static constexpr std::size_t HistorySize = 240;
+
+    struct Sample {
+        // A string literal, the name is not copied.
+        const char* name;
+        int depth;
+        // From the beginning of the frame
+        double cpu_begin_ms;
+        double cpu_ms;
+        // Negative when the scope was not timed on the GPU
+        double gpu_ms;
+        int query;
+    };
+
+    struct Frame {
+        long long index = 0;
+        // Since the profiler was created
+        double begin_ms = 0.0;
+        double cpu_ms = 0.0;
+        // Sum of the samples timed on the GPU
+        double gpu_ms = 0.0;
+        std::vector<Sample> samples;
+    };
+
+    // Mean of a scope over the history, scopes are told apart by name and depth.
+    struct Average {
+        const char* name;
+        int depth;
+        double cpu_ms;
+        double gpu_ms;
+        int count;
+        int gpu_count;
+    };
+
+    static Profiler& Shared();
+
+    Profiler(const Profiler&) = delete;
+    Profiler& operator=(const Profiler&) = delete;
+
+    // Resolve the frame that used this set of queries before and start recording a new one.
+    void BeginFrame();
+    void EndFrame();
+    void Begin(const char* name, bool gpu = true);
+    void End();
+
+    // The resolved frames in the history, GetFrame(0) is the oldest one.
+    std::size_t FrameCount() const;
+    const Frame& GetFrame(std::size_t index) const;
+    // Averages of every scope in the history, in the order of the first appearance.
+    void Averages(std::vector<Average>& averages) const;
+    void Clear();
+
+    // Chrome trace-event JSON (chrome://tracing, Perfetto): CPU scopes on thread 1, GPU scopes on thread 2.
+    bool WriteChromeTrace(const std::string& file_path) const;
+
+    // Delete the queries while the OpenGL context is still alive.
+    void Destroy();
+
+    // Takes effect at the next BeginFrame()
+    bool enabled = false;
+
+private:
+    Profiler();
+
+    double Now() const;
+
+    std::chrono::steady_clock::time_point m_origin;
+    long long m_frame_index = 0;
+    bool m_recording = false;
+    // The sample which owns the running GL_TIME_ELAPSED query, -1 if none
+    int m_gpu_owner = -1;
+    std::vector<int> m_open;
+
+    // The frame being recorded and the one waiting for its queries, one per set of queries
+    Frame m_pending[FramesInFlight];
+    bool m_has_pending[FramesInFlight] = {};
+    std::vector<GLuint> m_queries[FramesInFlight];
+    std::size_t m_used_queries[FramesInFlight] = {};
+    int m_slot = 0;
+
+    // Ring buffer of HistorySize frames, a new frame takes the storage of the oldest one so recording does not allocate.
+    std::vector<Frame> m_history;
+    std::size_t m_history_begin = 0;
+    std::size_t m_history_count = 0;
+};
+
+// Times the enclosing block, e.g. { ProfileScope scope("Screen"); ... }
+struct ProfileScope {
+    explicit ProfileScope(const char* name, bool gpu = true) {
+        Profiler::Shared().Begin(name, gpu);
+    }
+    ~ProfileScope() {
+        Profiler::Shared().End();
+    }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+};
+
+#endif
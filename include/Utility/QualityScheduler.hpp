@@ -0,0 +1,47 @@
+#ifndef QUALITYSCHEDULER_HPP
+#define QUALITYSCHEDULER_HPP
+
+#include <glm/glm.hpp>
+
+/**
+ * Picks the resolution of the volume pass from the interaction with the scene.
+ *
+ * 攝影機移動或 transfer function 改變時，volume 以 1/2 或 1/4 的解析度（和較大的取樣間距）繪製再放大，
+ * 哪一個等級由上一個 frame 的時間和目標時間決定；停止操作之後每個 frame 提高一級，直到回到完整畫質。
+ * VolumeRenderer corrects the opacity at the larger steps even when World::use_opacity_correction is off,
+ * so every level converges to the same density as the full quality image.
+ */
+struct QualityScheduler {
+    // Level n renders the volume at 1 / 2^n of the window size.
+    static constexpr int MaxLevel = 2;
+
+    bool enabled = true;
+    float target_frame_time = 33.3f;
+    // Frames without any change before the refinement starts.
+    int refine_delay = 4;
+
+    // Something which changes the image (e.g. the transfer function) happened this frame.
+    void Invalidate();
+    void ObserveCamera(const glm::mat4& view);
+    // Once per frame before rendering, frame_time (ms) is the time of the previous frame.
+    void Update(float frame_time);
+
+    int Level() const;
+    int Divisor() const;
+    // The sample step grows with the pixel footprint, VolumeRenderer corrects the opacity for it.
+    float StepScale() const;
+    bool IsInteracting() const;
+    // The image is still below full quality, the coming frames will refine it.
+    bool IsRefining() const;
+    const char* ShowLevel() const;
+
+private:
+    int m_level = 0;
+    int m_interaction_level = 1;
+    int m_idle_frames = 0;
+    bool m_changed = false;
+    bool m_has_view = false;
+    glm::mat4 m_last_view = glm::mat4(1.0f);
+};
+
+#endif
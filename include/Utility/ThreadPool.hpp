@@ -0,0 +1,69 @@
+#ifndef THREADPOOL_HPP
+#define THREADPOOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * A fixed set of worker threads for data-parallel loops.
+ *
+ * ParallelFor() 會把範圍切成數個 chunk，呼叫端的執行緒也會一起執行 chunk，
+ * 所以在 worker 裡面再呼叫 ParallelFor() 也不會 deadlock，而且 thread count = 1 時就是單純的序列執行。
+ * Resize() may run while another thread is inside ParallelFor() (e.g. a cancelled volume load which has not finished yet),
+ * that one only reads the atomic worker count and keeps running its chunks by itself while the workers restart.
+ */
+struct ThreadPool {
+    // thread_count includes the calling thread, 0 means every hardware thread.
+    explicit ThreadPool(unsigned int thread_count = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void Resize(unsigned int thread_count);
+    unsigned int Size() const;
+
+    // Run body(chunk_begin, chunk_end) over [begin, end) in chunks of at most `grain` items, blocks until all are done.
+    void ParallelFor(int begin, int end, int grain, const std::function<void(int, int)>& body);
+
+    // The pool shared by the whole application (volume loading, preprocessing, ...).
+    static ThreadPool& Shared();
+    static unsigned int HardwareThreads();
+
+private:
+    struct Job {
+        std::function<void(int, int)> body;
+        int begin = 0;
+        int end = 0;
+        int grain = 1;
+        int chunk_count = 0;
+        std::atomic<int> next_chunk { 0 };
+        std::atomic<int> remaining_chunks { 0 };
+
+        std::mutex done_mutex;
+        std::condition_variable done_condition;
+    };
+
+    void StartWorkers(unsigned int worker_count);
+    void StopWorkers();
+    void WorkerLoop();
+    void RunChunks(const std::shared_ptr<Job>& job);
+    void RemoveJob(const std::shared_ptr<Job>& job);
+
+    // Only Resize() and the destructor touch the threads, one at a time
+    std::mutex m_workers_mutex;
+    std::vector<std::thread> m_workers;
+    std::atomic<unsigned int> m_worker_count { 0 };
+    std::deque<std::shared_ptr<Job>> m_jobs;
+    std::mutex m_jobs_mutex;
+    std::condition_variable m_jobs_condition;
+    bool m_stop = false;
+};
+
+#endif
@@ -0,0 +1,25 @@
+#ifndef WORKSTEALINGSCHEDULER_HPP
+#define WORKSTEALINGSCHEDULER_HPP
+
+#include <cstddef>
+#include <functional>
+
+#include "Utility/ThreadPool.hpp"
+
+/**
+ * Runs independent tasks of uneven cost (e.g. image tiles) with one deque per worker.
+ *
+ * 每個 worker 先從自己 deque 的前端拿工作（相鄰的 tile，cache 比較友善），
+ * 自己的做完了再從其他 worker deque 的尾端偷工作，所以很貴的區域不會卡在同一個執行緒上。
+ */
+struct WorkStealingScheduler {
+    struct Statistics {
+        std::size_t tasks = 0;
+        std::size_t steals = 0;
+    };
+
+    // task(index, worker) for every index in [0, count), one worker per thread of the pool.
+    static Statistics Run(ThreadPool& pool, int count, const std::function<void(int, int)>& task);
+};
+
+#endif
@@ -0,0 +1,75 @@
+#ifndef SCENESNAPSHOT_HPP
+#define SCENESNAPSHOT_HPP
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+
+#include "World/World.hpp"
+#include "GUI/TransferFunctionWidget.hpp"
+
+/**
+ * The state the render passes read, captured once per frame to find out what has to be redrawn.
+ *
+ * GUI 會直接改 World 裡的設定，所以不在每個地方設 dirty flag，而是每個 frame 比較一次快照：
+ * volume 與 bloom 讀到的部份沒變就沿用上一次的結果，只重新合成畫面與 ImGui。
+ */
+struct SceneSnapshot {
+    static SceneSnapshot Capture(const World& world, const TransferFunctionWidget& transfer_function);
+
+    // The volume and the bloom passes have to run again.
+    bool SceneDiffers(const SceneSnapshot& other) const;
+    // Only the screen pass (post effects, tone mapping) has to run again.
+    bool ScreenDiffers(const SceneSnapshot& other) const;
+
+    // Camera
+    glm::mat4 view;
+    float zoom;
+    bool is_perspective;
+    int viewport_width;
+    int viewport_height;
+
+    // Light
+    glm::vec3 light_position;
+    glm::vec3 light_color;
+    bool light_enable;
+
+    // Volume and transfer function
+    const Volume* volume;
+    std::size_t transfer_function_version;
+
+    // World settings read by the volume and the bloom passes
+    bool draw_axes;
+    bool culling;
+    bool use_empty_space_skipping;
+    bool use_slab_ray_setup;
+    bool use_preintegration;
+    bool use_opacity_correction;
+    bool use_adaptive_sampling;
+    bool use_lighting;
+    bool use_normal_color;
+    bool use_bloom;
+    bool use_ray_statistics;
+    float opacity_reference_step;
+    float adaptive_max_step_scale;
+    float adaptive_importance_threshold;
+    float sample_rate;
+    float bloom_threshold;
+    int bloom_strength;
+    BloomMethod bloom_method;
+    int bloom_mip_levels;
+    float bloom_filter_radius;
+    int quality_level;
+    glm::vec3 background_color;
+
+    // World settings read by the screen pass only
+    PostEffect screen_mode;
+    float bloom_intensity;
+    bool use_gamma_correction;
+    float gamma_value;
+    bool use_hdr;
+    HDRMode hdr_mode;
+    float hdr_exposure;
+};
+
+#endif
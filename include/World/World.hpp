@@ -10,6 +10,7 @@
 #include "Geometry/2D/Screen.hpp"
 
 #include "Model/Volume.hpp"
+#include "Model/VolumeLoader.hpp"
 
 #include "Entity.hpp"
 #include "Material/Material.hpp"
@@ -20,6 +21,8 @@
 
 #include "Texture/Texture1D.hpp"
 
+#include "Utility/QualityScheduler.hpp"
+
 enum PostEffect : unsigned int {
     NORMAL = 0,
     INVERSION = 1,
@@ -29,6 +32,11 @@ enum PostEffect : unsigned int {
     EDGE_DETECTION = 5,
 };
 
+enum BloomMethod : unsigned int {
+    MIP_CHAIN = 0,
+    GAUSSIAN_BLUR = 1,
+};
+
 enum HDRMode : unsigned int {
     REINHARD = 0,
     EXPOSURE = 1,
@@ -42,6 +50,7 @@ struct World {
 
     // Voxel
     std::unique_ptr<Volume> my_volume = nullptr;
+    VolumeLoader volume_loader;
 
     // Entity (For movement)
     Entity camera;
@@ -67,7 +76,16 @@ struct World {
     bool use_bloom = true;
     float bloom_intensity = 1.0f;
     float bloom_threshold = 0.7f;
+    // Ping-pong passes of the full resolution gaussian blur
     int bloom_strength = 20;
+    // Of the current frame graph, for the GUI
+    int frame_graph_passes = 0;
+    int frame_graph_live_passes = 0;
+    BloomMethod current_bloom_method = BloomMethod::MIP_CHAIN;
+    // Depth of the mip chain, every level doubles the radius of the blur
+    int bloom_mip_levels = 6;
+    // Radius of the upsampling tent filter, in texels of the smaller level
+    float bloom_filter_radius = 1.0f;
 
     // Gamma Correction
     bool use_gamma_correction = true;
@@ -82,6 +100,27 @@ struct World {
     char volume_data_folder_path[1024] = "assets/volumes";
     std::string current_volume_data = "Please select a volume file (.toml)";
     std::vector<std::string> volume_data_files;
+    int worker_threads = 0;
+    VolumeTextureLayout volume_texture_layout = VolumeTextureLayout::PackedFloat;
+    bool use_empty_space_skipping = true;
+    // Entry and exit of the rays from a slab test in texture space, off: from the front faces with a bounds test per step
+    bool use_slab_ray_setup = true;
+    bool use_preintegration = false;
+    // The transfer function is designed at this step, other steps correct the opacity to look the same.
+    bool use_opacity_correction = false;
+    float opacity_reference_step = 0.5f;
+    // Per-brick step length: up to max_step_scale * sample_rate where the values vary less than the threshold.
+    bool use_adaptive_sampling = false;
+    float adaptive_max_step_scale = 4.0f;
+    float adaptive_importance_threshold = 0.1f;
+    // Resolution of the volume pass while interacting (progressive refinement)
+    QualityScheduler quality;
+    // Render-on-demand: the volume and the bloom passes only run when something they read has changed
+    bool render_on_demand = true;
+    std::size_t skipped_frames = 0;
+    // Measured from the last rendered frames, see Game::UpdateRayStatistics(). Off: the volume pass does not write the statistics target.
+    bool use_ray_statistics = false;
+    float average_samples_per_ray = 0.0f;
     bool use_lighting = true;
     bool use_normal_color = false;
     float sample_rate = 0.5f;
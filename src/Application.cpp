@@ -2,10 +2,23 @@
 
 #include <SDL.h>
 #include <glad/glad.h>
+#include <glm/gtc/constants.hpp>
 
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <string>
+
+#include "GL/RenderTargetPool.hpp"
 #include "GUI/GUI.hpp"
+#include "Shader/ShaderCache.hpp"
 #include "Window.hpp"
 #include "Utility/Logger.hpp"
+#include "Utility/MemoryUsage.hpp"
+#include "Utility/FrameStatistics.hpp"
+#include "Utility/Profiler.hpp"
+#include "Utility/ThreadPool.hpp"
+#include "World/SceneSnapshot.hpp"
 
 #include "State.hpp"
 
@@ -14,6 +27,7 @@ Application::Application(const Config& config) : my_config(config) {
 }
 
 Application::~Application() {
+    Profiler::Shared().Destroy();
     state.ui->Destroy();
     SDL_GL_DeleteContext(state.context);
     SDL_DestroyWindow(state.window->handler);
@@ -23,6 +37,10 @@ Application::~Application() {
 void Application::Initialize() {
     Logger::ShowMe();
 
+    // Worker threads for volume preprocessing
+    ThreadPool::Shared().Resize(my_config.worker_threads);
+    Logger::Message(LogLevel::Info, "Thread pool size: " + std::to_string(ThreadPool::Shared().Size()));
+
     // Initialize SDL2
     if (SDL_Init(SDL_INIT_VIDEO) != 0) {
         Logger::Message(LogLevel::SDLError, "Oops! Failed to initialize SDL2. :(");
@@ -45,8 +63,13 @@ void Application::Initialize() {
     SDL_GL_SetAttribute(SDL_GL_MULTISAMPLEBUFFERS, 1);
     SDL_GL_SetAttribute(SDL_GL_MULTISAMPLESAMPLES, 4);
 
-    // Other Settings
-    SDL_GL_SetAttribute(SDL_GL_ACCELERATED_VISUAL, 1);
+    // Other Settings (a software implementation like Mesa llvmpipe has no accelerated visual)
+    const char* software_gl = std::getenv("LIBGL_ALWAYS_SOFTWARE");
+    if (software_gl == nullptr || std::string(software_gl) == "0") {
+        SDL_GL_SetAttribute(SDL_GL_ACCELERATED_VISUAL, 1);
+    } else {
+        Logger::Message(LogLevel::Info, "LIBGL_ALWAYS_SOFTWARE is set, requesting a software OpenGL context.");
+    }
 
     // Create a window
     state.window = std::make_unique<Window>();
@@ -54,6 +77,11 @@ void Application::Initialize() {
         const auto flags = SDL_WINDOW_OPENGL | SDL_WINDOW_FULLSCREEN_DESKTOP | SDL_WINDOW_ALLOW_HIGHDPI;
         state.window->handler = SDL_CreateWindow(my_config.title.c_str(), SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED,
                                               0, 0, flags);
+    } else if (my_config.benchmark) {
+        // 固定大小且不顯示的視窗，讓每次 benchmark 的結果可以互相比較
+        const auto flags = SDL_WINDOW_OPENGL | SDL_WINDOW_HIDDEN;
+        state.window->handler = SDL_CreateWindow(my_config.title.c_str(), SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
+                                              my_config.width, my_config.height, flags);
     } else {
         const auto flags = SDL_WINDOW_OPENGL | SDL_WINDOW_RESIZABLE | SDL_WINDOW_ALLOW_HIGHDPI;
         state.window->handler = SDL_CreateWindow(my_config.title.c_str(), SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
@@ -74,8 +102,8 @@ void Application::Initialize() {
     SDL_GL_MakeCurrent(state.window->handler, state.context);
     Logger::Message(LogLevel::Info, "Create OpenGL context successfully.");
 
-    // This make our buffers swap synchronized with the monitor's vertical refresh
-    SDL_GL_SetSwapInterval(1);
+    // This make our buffers swap synchronized with the monitor's vertical refresh (off for benchmarks)
+    SDL_GL_SetSwapInterval(my_config.vsync ? 1 : 0);
 
     // Setting the mouse mode
     SDL_SetHintWithPriority(SDL_HINT_MOUSE_RELATIVE_MODE_WARP, "1", SDL_HINT_OVERRIDE);
@@ -94,51 +122,226 @@ void Application::Initialize() {
     // 輸出訊息
     Logger::ShowGLInfo();
 
+    // Before any shader is built
+    ShaderCache::Initialize(my_config.shader_cache_directory);
+
     state.ui = std::make_unique<GUI>(state.window->handler, state.context);
 
     game = std::make_unique<Game>();
+    if (my_config.gaussian_bloom) {
+        state.world->current_bloom_method = BloomMethod::GAUSSIAN_BLUR;
+    }
+    if (my_config.legacy_ray_setup) {
+        state.world->use_slab_ray_setup = false;
+    }
 }
 
 void Application::Run() {
+    if (my_config.benchmark) {
+        RunBenchmark();
+        game->Destroy();
+        return;
+    }
+
+    SceneSnapshot last_snapshot {};
+    bool has_snapshot = false;
+    int idle_frames = 0;
+
     // The game main loop
     while (!state.window->should_close) {
+        // 畫面已經好幾個 frame 沒有任何變化：睡到有事件為止（逾時是為了讓 GUI 的數據偶爾更新）
+        if (state.world->render_on_demand && idle_frames >= IdleFramesBeforeWaiting) {
+            SDL_WaitEventTimeout(nullptr, IdleWaitTimeout);
+            last_time = static_cast<float>(SDL_GetTicks()) / 1000.0f;
+        }
 
         // 計算每 frame 的變化時間
         current_time = static_cast<float>(SDL_GetTicks()) / 1000.0f;
         delta_time = current_time - last_time;
         last_time = current_time;
 
-        // 事件處理
-        game->HandleEvents();
+        // The waiting above is not part of the frame.
+        Profiler::Shared().BeginFrame();
 
-        // 更新數據
-        game->Update(delta_time);
+        {
+            ProfileScope scope("Update", false);
+            // 事件處理
+            game->HandleEvents();
 
-        // 呼叫 renderer 來清除快取
-        game->RendererInit();
+            // 更新數據
+            game->Update(delta_time);
+            state.world->quality.Update(delta_time * 1000.0f);
+        }
 
-        // Render Objects
-        state.world->my_camera->viewport = { 0, 0, state.window->width, state.window->height };
-        game->Render(state.world->my_camera);
+        // The GUI of the last frame may have changed the settings as well, they are in the snapshot now.
+        const SceneSnapshot snapshot = SceneSnapshot::Capture(*state.world, state.ui->m_transfer_function);
+        const bool scene_changed = !has_snapshot || snapshot.SceneDiffers(last_snapshot);
+        const bool screen_changed = !has_snapshot || snapshot.ScreenDiffers(last_snapshot);
+        last_snapshot = snapshot;
+        has_snapshot = true;
 
-        // 記得將 Viewport 切回正常大小，並且 Viewport settings
-        state.world->my_camera->viewport = { 0, 0, state.window->width, state.window->height };
-        state.world->my_camera->SetViewPort();
+        const bool render_scene = scene_changed || !state.world->render_on_demand;
+        if (!render_scene) {
+            state.world->skipped_frames++;
+        }
+        RenderFrame(nullptr, render_scene);
+        Profiler::Shared().EndFrame();
+        AllocationCounter::EndFrame();
+        RenderTargetPool::Shared().EndFrame();
 
-        // 執行高斯模糊，用於 Bloom 效果
-        game->RenderGaussianBlur();
-
-        // 繪製 Screen
-        game->RenderScreen();
-
-        // 繪製 ImGui
-        state.ui->Render();
-
-        // 切換 Buffer
-        SDL_GL_SwapWindow(state.window->handler);
+        // 降低解析度的畫面還沒回到完整畫質之前不能等待事件，否則每次操作結束都會停頓 IdleWaitTimeout 才開始 refine
+        const bool is_idle = !game->HasEvents() && !scene_changed && !screen_changed && !state.world->volume_loader.IsBusy()
+                             && !state.world->quality.IsRefining();
+        idle_frames = is_idle ? idle_frames + 1 : 0;
     }
 
     // Clean Up
     game->Destroy();
     Logger::Message(LogLevel::Info, "Good Bye :)");
-}
\ No newline at end of file
+}
+
+void Application::RenderFrame(TimerQuery* timer, bool render_scene) {
+    const auto begin_pass = [timer](FramePass pass) {
+        if (timer != nullptr) {
+            timer->Begin(static_cast<int>(pass));
+        }
+    };
+    const auto end_pass = [timer]() {
+        if (timer != nullptr) {
+            timer->End();
+        }
+    };
+
+    // A rebuilt frame graph holds no results of an earlier frame
+    render_scene = game->PrepareFrameGraph() || render_scene;
+    const AllocationCounter::Totals allocations = AllocationCounter::Current();
+
+    // PostProcessing 與 GaussianBlur 的材質會保留到下一個 frame，所以沒有變化時可以直接拿來合成
+    if (render_scene) {
+        begin_pass(FramePass::Volume);
+        // Render Objects, into the lower left part of the targets
+        state.world->my_camera->viewport = { 0, 0, game->RenderWidth(), game->RenderHeight() };
+        game->RenderScene();
+        end_pass();
+    }
+    game->UpdateRayStatistics(render_scene);
+
+    // 記得將 Viewport 切回正常大小，並且 Viewport settings
+    state.world->my_camera->viewport = { 0, 0, state.window->width, state.window->height };
+    state.world->my_camera->SetViewPort();
+
+    // 執行高斯模糊，用於 Bloom 效果
+    if (render_scene) {
+        begin_pass(FramePass::Bloom);
+        game->RenderBloom();
+        end_pass();
+    }
+
+    // 繪製 Screen
+    begin_pass(FramePass::Screen);
+    game->RenderScreen();
+    end_pass();
+    render_allocations += AllocationCounter::Current() - allocations;
+
+    // 繪製 ImGui
+    begin_pass(FramePass::GUI);
+    state.ui->Render();
+    end_pass();
+
+    // 切換 Buffer
+    ProfileScope scope("Swap", false);
+    SDL_GL_SwapWindow(state.window->handler);
+}
+
+void Application::RunBenchmark() {
+    Logger::Message(LogLevel::Info, "Benchmark: " + my_config.benchmark_volume + " with " + my_config.benchmark_transfer_function);
+    Logger::Message(LogLevel::Info, std::string("Bloom: ") + (state.world->current_bloom_method == BloomMethod::MIP_CHAIN ? "mip chain" : "gaussian blur"));
+
+    // Every frame is measured at full quality.
+    state.world->quality.enabled = false;
+
+    // 1. The volume and the transfer function are loaded synchronously, the timings start with them on the GPU.
+    if (!state.ui->m_transfer_function.LoadPreset(my_config.benchmark_transfer_function)) {
+        exit(-1);
+    }
+    auto volume = std::make_unique<Volume>(my_config.benchmark_volume, "", RawLoadMethod::MemoryMapped, nullptr,
+                                           state.world->volume_texture_layout);
+    if (!volume->IsLoaded()) {
+        exit(-1);
+    }
+    volume->Upload();
+    volume->GenerateTFTexture(state.ui->m_transfer_function);
+    state.world->my_volume = std::move(volume);
+
+    // 2. A deterministic orbit around the volume: one full turn over the measured frames, the pitch swings by +-20 degrees.
+    const int warmup_frames = my_config.benchmark_warmup_frames;
+    const int measured_frames = my_config.benchmark_frames;
+    const float fixed_delta_time = 1.0f / 60.0f;
+    const auto orbit = [measured_frames](int frame) {
+        const float phase = static_cast<float>(frame) / static_cast<float>(measured_frames);
+        return glm::vec3(20.0f * std::sin(phase * 2.0f * glm::pi<float>()), 360.0f * phase, 0.0f);
+    };
+
+    TimerQuery timer(static_cast<int>(FramePass::Count));
+    FrameStatistics statistics({"cpu_ms", "frame_ms", "gpu_volume_ms", "gpu_bloom_ms", "gpu_screen_ms", "gpu_gui_ms", "gpu_total_ms"});
+    std::vector<std::vector<double>> pending(timer.FramesInFlight());
+
+    const auto record = [&](long long frame) {
+        std::vector<double>& values = pending[frame % timer.FramesInFlight()];
+        double gpu_total = 0.0;
+        for (const double gpu : timer.Resolve(frame)) {
+            values.push_back(gpu);
+            gpu_total += gpu;
+        }
+        values.push_back(gpu_total);
+        if (frame >= warmup_frames) {
+            statistics.AddFrame(values);
+        }
+        values.clear();
+    };
+
+    auto last_frame_end = std::chrono::steady_clock::now();
+    const long long total_frames = warmup_frames + measured_frames;
+    for (long long frame = 0; frame < total_frames && !state.window->should_close; frame++) {
+        // The queries of this slot are reused, read the frame which used them first.
+        if (frame >= timer.FramesInFlight()) {
+            record(frame - timer.FramesInFlight());
+        }
+
+        auto frame_start = std::chrono::steady_clock::now();
+        timer.BeginFrame(frame);
+
+        if (frame == warmup_frames) {
+            render_allocations = {};
+        }
+
+        game->HandleEvents();
+        state.world->camera.rotate = orbit(static_cast<int>(std::max(frame - warmup_frames, 0LL)));
+        game->Update(fixed_delta_time);
+        RenderFrame(&timer);
+        RenderTargetPool::Shared().EndFrame();
+
+        auto frame_end = std::chrono::steady_clock::now();
+        const std::chrono::duration<double, std::milli> cpu = frame_end - frame_start;
+        const std::chrono::duration<double, std::milli> wall = frame_end - last_frame_end;
+        last_frame_end = frame_end;
+        pending[frame % timer.FramesInFlight()] = {cpu.count(), wall.count()};
+    }
+    for (long long frame = std::max(total_frames - timer.FramesInFlight(), 0LL); frame < total_frames; frame++) {
+        record(frame);
+    }
+
+    // 3. Results
+    Logger::Message(LogLevel::Info, "Renderer: " + std::string(reinterpret_cast<const char*>(glGetString(GL_RENDERER))));
+    statistics.LogSummary();
+    const RenderTargetPool::Counters& targets = RenderTargetPool::Shared().GetCounters();
+    Logger::Message(LogLevel::Info, "Render target allocations: " + std::to_string(targets.allocations) + " (" + MemoryUsage::FormatBytes(targets.allocated_bytes)
+                                    + "), " + std::to_string(targets.reuses) + " reuses, " + MemoryUsage::FormatBytes(targets.live_bytes) + " live");
+    if (AllocationCounter::IsEnabled() && measured_frames > 0) {
+        Logger::Message(LogLevel::Info, "Render pass allocations: " + std::to_string(render_allocations.count / measured_frames) + " per frame ("
+                                        + std::to_string(render_allocations.bytes / measured_frames) + " bytes)");
+    }
+    if (statistics.WriteCSV(my_config.benchmark_output)) {
+        Logger::Message(LogLevel::Info, "Benchmark results written to " + my_config.benchmark_output);
+    }
+}
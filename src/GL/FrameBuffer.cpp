@@ -28,18 +28,50 @@ void FrameBuffer::SetDrawBufferAmount(int amount) {
     UnBind();
 }
 
+void FrameBuffer::SetDrawBuffers(std::initializer_list<bool> enabled) {
+    attachments.clear();
+    unsigned int attachment = 0;
+    for (bool is_enabled : enabled) {
+        attachments.push_back(is_enabled ? GL_COLOR_ATTACHMENT0 + attachment : GL_NONE);
+        attachment++;
+    }
+
+    Bind();
+    glDrawBuffers(static_cast<GLsizei>(attachments.size()), attachments.data());
+    UnBind();
+}
+
 void FrameBuffer::BindTexture2D(const Texture2D& texture, unsigned int attachment) {
     Bind();
     glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + attachment, GL_TEXTURE_2D, texture.id, 0);
     UnBind();
 }
 
+void FrameBuffer::DetachTexture2D(unsigned int attachment) {
+    Bind();
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + attachment, GL_TEXTURE_2D, 0, 0);
+    UnBind();
+}
+
 void FrameBuffer::BindRenderBuffer(const std::unique_ptr<RenderBuffer>& rbo) {
     Bind();
     glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, rbo->ID);
     UnBind();
 }
 
+void FrameBuffer::BlitColor(FrameBuffer& target, unsigned int attachment, int width, int height, int target_width, int target_height) {
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, ID);
+    glReadBuffer(GL_COLOR_ATTACHMENT0 + attachment);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, target.ID);
+    glDrawBuffer(GL_COLOR_ATTACHMENT0 + attachment);
+    glBlitFramebuffer(0, 0, width, height, 0, 0, target_width, target_height, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+
+    // Restore the draw buffers of both
+    glDrawBuffers(static_cast<GLsizei>(target.attachments.size()), target.attachments.data());
+    glReadBuffer(GL_COLOR_ATTACHMENT0);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
 void FrameBuffer::CheckComplete() {
     Bind();
     if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
@@ -0,0 +1,125 @@
+#include "GL/RenderTargetPool.hpp"
+
+#include <algorithm>
+
+glm::vec2 RenderTarget::Region() const {
+    return { static_cast<float>(width) / static_cast<float>(allocated_width), static_cast<float>(height) / static_cast<float>(allocated_height) };
+}
+
+RenderTargetPool& RenderTargetPool::Shared() {
+    static RenderTargetPool pool;
+    return pool;
+}
+
+int RenderTargetPool::BucketSize(int size) {
+    return (std::max(size, 1) + Bucket - 1) / Bucket * Bucket;
+}
+
+RenderTarget RenderTargetPool::Create(const std::string& name, int width, int height) {
+    RenderTarget target;
+    target.width = width;
+    target.height = height;
+    target.allocated_width = BucketSize(width);
+    target.allocated_height = BucketSize(height);
+    target.texture = TextureManager::CreateRenderTarget(target.allocated_width, target.allocated_height, name);
+    CountAllocation(target.texture, 0);
+    return target;
+}
+
+bool RenderTargetPool::Fit(RenderTarget& target, int width, int height) {
+    target.width = width;
+    target.height = height;
+
+    const int bucket_width = BucketSize(width), bucket_height = BucketSize(height);
+    const bool too_small = target.allocated_width < width || target.allocated_height < height;
+    const bool too_large = static_cast<long long>(target.allocated_width) * target.allocated_height
+                           > 2LL * bucket_width * bucket_height;
+    if (!too_small && !too_large) {
+        return false;
+    }
+
+    const std::size_t previous_bytes = TextureManager::GetTextureInfo(target.texture).bytes;
+    target.allocated_width = bucket_width;
+    target.allocated_height = bucket_height;
+    TextureManager::ResizeRenderTarget(target.texture, bucket_width, bucket_height);
+    CountAllocation(target.texture, previous_bytes);
+    return true;
+}
+
+TransientTarget RenderTargetPool::Acquire(int width, int height) {
+    const int bucket_width = BucketSize(width), bucket_height = BucketSize(height);
+
+    int free_slot = -1;
+    for (int i = 0; i < static_cast<int>(m_entries.size()); i++) {
+        Entry& entry = m_entries[i];
+        if (!entry.alive) {
+            free_slot = free_slot < 0 ? i : free_slot;
+            continue;
+        }
+        if (!entry.in_use && entry.target.allocated_width == bucket_width && entry.target.allocated_height == bucket_height) {
+            entry.in_use = true;
+            entry.last_used = m_frame;
+            entry.target.width = width;
+            entry.target.height = height;
+            m_counters.reuses++;
+            return i;
+        }
+    }
+
+    // None of this bucket is free: a new target, in the slot of a trimmed one if there is one
+    if (free_slot < 0) {
+        free_slot = static_cast<int>(m_entries.size());
+        m_entries.emplace_back();
+    }
+    Entry& entry = m_entries[free_slot];
+    entry.target = Create("Transient" + std::to_string(free_slot), width, height);
+    entry.framebuffer = std::make_unique<FrameBuffer>();
+    entry.framebuffer->BindTexture2D(TextureManager::GetTexture2D(entry.target.texture), 0);
+    entry.framebuffer->CheckComplete();
+    entry.alive = true;
+    entry.in_use = true;
+    entry.last_used = m_frame;
+    return free_slot;
+}
+
+void RenderTargetPool::Release(TransientTarget transient) {
+    m_entries[transient].in_use = false;
+}
+
+const RenderTarget& RenderTargetPool::Target(TransientTarget transient) const {
+    return m_entries[transient].target;
+}
+
+FrameBuffer& RenderTargetPool::Framebuffer(TransientTarget transient) {
+    return *m_entries[transient].framebuffer;
+}
+
+void RenderTargetPool::EndFrame() {
+    for (Entry& entry : m_entries) {
+        if (entry.alive && !entry.in_use && m_frame - entry.last_used >= TrimFrames) {
+            m_counters.live_bytes -= TextureManager::GetTextureInfo(entry.target.texture).bytes;
+            TextureManager::Release(entry.target.texture);
+            entry.framebuffer.reset();
+            entry.alive = false;
+        }
+    }
+    m_frame++;
+}
+
+const RenderTargetPool::Counters& RenderTargetPool::GetCounters() const {
+    return m_counters;
+}
+
+void RenderTargetPool::Destroy() {
+    for (Entry& entry : m_entries) {
+        entry.framebuffer.reset();
+    }
+    m_entries.clear();
+}
+
+void RenderTargetPool::CountAllocation(TextureHandle texture, std::size_t previous_bytes) {
+    const std::size_t bytes = TextureManager::GetTextureInfo(texture).bytes;
+    m_counters.allocations++;
+    m_counters.allocated_bytes += bytes;
+    m_counters.live_bytes = m_counters.live_bytes - previous_bytes + bytes;
+}
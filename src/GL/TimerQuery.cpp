@@ -0,0 +1,53 @@
+#include "GL/TimerQuery.hpp"
+
+TimerQuery::TimerQuery(int pass_count, int frames_in_flight) :
+    m_pass_count(pass_count), m_frames_in_flight(frames_in_flight), m_current_slot(0),
+    m_queries(pass_count * frames_in_flight, 0), m_issued(pass_count * frames_in_flight, false) {
+    glGenQueries(static_cast<GLsizei>(m_queries.size()), m_queries.data());
+}
+
+TimerQuery::~TimerQuery() {
+    glDeleteQueries(static_cast<GLsizei>(m_queries.size()), m_queries.data());
+}
+
+void TimerQuery::BeginFrame(long long frame_index) {
+    m_current_slot = static_cast<int>(frame_index % m_frames_in_flight);
+    for (int pass = 0; pass < m_pass_count; pass++) {
+        m_issued[m_current_slot * m_pass_count + pass] = false;
+    }
+}
+
+void TimerQuery::Begin(int pass) {
+    const int index = m_current_slot * m_pass_count + pass;
+    m_issued[index] = true;
+    glBeginQuery(GL_TIME_ELAPSED, m_queries[index]);
+}
+
+void TimerQuery::End() {
+    glEndQuery(GL_TIME_ELAPSED);
+}
+
+std::vector<double> TimerQuery::Resolve(long long frame_index) {
+    const int slot = static_cast<int>(frame_index % m_frames_in_flight);
+    std::vector<double> results(m_pass_count, 0.0);
+    for (int pass = 0; pass < m_pass_count; pass++) {
+        const int index = slot * m_pass_count + pass;
+        if (!m_issued[index]) {
+            continue;
+        }
+
+        GLuint64 nanoseconds = 0;
+        glGetQueryObjectui64v(m_queries[index], GL_QUERY_RESULT, &nanoseconds);
+        results[pass] = static_cast<double>(nanoseconds) / 1.0e6;
+        m_issued[index] = false;
+    }
+    return results;
+}
+
+int TimerQuery::PassCount() const {
+    return m_pass_count;
+}
+
+int TimerQuery::FramesInFlight() const {
+    return m_frames_in_flight;
+}
@@ -2,8 +2,8 @@
 
 std::vector<float> CubicBezier::m_coefficient;
 
-std::vector<ImVec2> CubicBezier::BezierTable(const std::array<ImVec2, 4>& control_points, const unsigned int& sample_points) {
-    std::vector<ImVec2> results;
+void CubicBezier::BezierTable(const std::array<ImVec2, 4>& control_points, const unsigned int& sample_points, std::vector<ImVec2>& results) {
+    results.clear();
 
     if (m_coefficient.size() != (sample_points + 1) * 4) {
         m_coefficient.resize((sample_points + 1) * 4, 0);
@@ -27,13 +27,12 @@ std::vector<ImVec2> CubicBezier::BezierTable(const std::array<ImVec2, 4>& contro
         };
         results.push_back(point);
     }
-
-    return results;
 }
 
 float CubicBezier::BezierValue(const float& t, const std::array<ImVec2, 2>& points) {
     float steps = 256;
     std::array<ImVec2, 4> control_pts {{ {1, 2}, points[0], points[1], {1, 1} }};
-    std::vector<ImVec2> results = BezierTable(control_pts, steps);
+    std::vector<ImVec2> results;
+    BezierTable(control_pts, steps, results);
     return results[static_cast<int>(t < 0 ? 0 : (t > 1 ? 1 : t)) * steps].y;
 }
\ No newline at end of file
@@ -107,7 +107,8 @@ bool CubicBezierWidget::DrawCanvas() {
 
     // Evaluate Curve
     std::array<ImVec2, 4> control_pts = {{{0, 0}, {m_points[0], m_points[1]}, {m_points[2], m_points[3]}, {1, 1}}};
-    std::vector<ImVec2> results = CubicBezier::BezierTable(control_pts, static_cast<int>(m_widget_config.smoothness));
+    std::vector<ImVec2>& results = m_curve;
+    CubicBezier::BezierTable(control_pts, static_cast<int>(m_widget_config.smoothness), results);
 
     // Control Points: 2 Lines and 2 Circles
     ImVec2 mouse = ImGui::GetIO().MousePos;
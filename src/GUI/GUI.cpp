@@ -5,7 +5,18 @@
 #include <imgui_impl_sdl.h>
 #include <glm/gtc/type_ptr.hpp>
 
+#include <algorithm>
+#include <cfloat>
+#include <cstdio>
+
 #include "State.hpp"
+#include "GL/RenderTargetPool.hpp"
+#include "Renderer/BloomRenderer.hpp"
+#include "Texture/TextureManager.hpp"
+#include "Utility/AllocationCounter.hpp"
+#include "Utility/MemoryUsage.hpp"
+#include "Utility/Profiler.hpp"
+#include "Utility/ThreadPool.hpp"
 
 GUI::GUI(SDL_Window* window, SDL_GLContext glContext) :
     WindowHandler(window),
@@ -36,6 +47,7 @@ void GUI::Destroy() {
 }
 
 void GUI::Render() {
+    ProfileScope scope("GUI");
     ImGui_ImplOpenGL3_NewFrame();
     ImGui_ImplSDL2_NewFrame(WindowHandler);
     ImGui::NewFrame();
@@ -65,6 +77,7 @@ void GUI::MenuBarRender() {
             ImGui::MenuItem("Transfer Function", nullptr, &Windows.TransferFunction.Visible);
             ImGui::MenuItem("Cubic Bezier", nullptr, &Windows.CubicBezier.Visible);
             ImGui::MenuItem("Settings", nullptr, &Windows.Settings.Visible);
+            ImGui::MenuItem("Profiler", nullptr, &Windows.Profiler.Visible);
             ImGui::EndMenu();
         }
 
@@ -93,6 +106,7 @@ void GUI::WindowsRender() {
     AboutRender();
     TransferFunctionRender();
     CubicBezierRender();
+    ProfilerRender();
 #ifndef NDEBUG
     // Demo Window Render
     if (Windows.Demo.Visible) {
@@ -278,7 +292,7 @@ void GUI::LightningInfoRender() {
         if (ImGui::BeginTabBar("TabBar##Window_LightningInfo")) {
 
             if (ImGui::BeginTabItem("Point Lights"))  {
-                if (ImGui::TreeNode(std::string("Point Light").c_str())) {
+                if (ImGui::TreeNode("Point Light")) {
                     if (ImGui::ColorEdit3("Color", glm::value_ptr(state.world->my_point_light->color))) {
                         state.world->my_point_light->UpdateColor();
                     }
@@ -292,7 +306,15 @@ void GUI::LightningInfoRender() {
                 ImGui::Checkbox("Enable", &state.world->use_bloom);
                 ImGui::SliderFloat("Intensity", &state.world->bloom_intensity, 0.0f, 2.0f);
                 ImGui::SliderFloat("Threshold", &state.world->bloom_threshold, 0.5f, 5.0f);
-                ImGui::SliderInt("Strength", &state.world->bloom_strength, 0.0f, 50.0f);
+                const char* items_bloom[] = { "Mip Chain", "Gaussian Blur" };
+                ImGui::Combo("Method", reinterpret_cast<int*>(&state.world->current_bloom_method), items_bloom, IM_ARRAYSIZE(items_bloom));
+                if (state.world->current_bloom_method == BloomMethod::MIP_CHAIN) {
+                    // The depth of the chain, each level doubles the radius
+                    ImGui::SliderInt("Strength", &state.world->bloom_mip_levels, 1, BloomRenderer::MaxLevels);
+                    ImGui::SliderFloat("Filter Radius", &state.world->bloom_filter_radius, 0.5f, 2.0f);
+                } else {
+                    ImGui::SliderInt("Strength", &state.world->bloom_strength, 0.0f, 50.0f);
+                }
                 ImGui::EndTabItem();
             }
 
@@ -344,10 +366,26 @@ void GUI::TransferFunctionRender() {
             if (state.world->current_volume_data == "Please select a volume file (.toml)") {
                 ImGui::OpenPopup("Error##NoChoseVolumeFile");
             } else {
+                // 交給背景執行緒讀取，讀取完成後 Game::Update() 會負責上傳與替換
                 std::string volume_file = std::string(state.world->volume_data_folder_path) + "/"+ state.world->current_volume_data;
-                state.world->my_volume = std::make_unique<Volume>(volume_file);
-                state.world->my_volume->GenerateTFTexture(m_transfer_function);
+                state.world->volume_loader.Start(volume_file, state.world->volume_texture_layout);
+            }
+        }
+        // 只會影響下一次讀取的 volume
+        const char* layout_items[] = {"RGBA32F", "Scalar + RGB8_SNORM Normal", "Scalar + RG16 Octahedral Normal"};
+        ImGui::Combo("Texture Layout", reinterpret_cast<int*>(&state.world->volume_texture_layout), layout_items, IM_ARRAYSIZE(layout_items));
+
+        // Loading Progress
+        if (state.world->volume_loader.IsBusy()) {
+            const LoadingProgress& progress = state.world->volume_loader.Progress();
+            ImGui::Text("Loading: %s", state.world->volume_loader.CurrentFile().c_str());
+            ImGui::ProgressBar(progress.fraction, ImVec2(-1.0f, 0.0f), progress.ShowStage());
+            if (ImGui::Button("Cancel Loading")) {
+                state.world->volume_loader.Cancel();
             }
+        } else if (!state.world->volume_loader.LastError().empty()) {
+            // 讀取失敗時保留原本的 volume，只顯示原因
+            ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "Failed to load: %s", state.world->volume_loader.LastError().c_str());
         }
 
         ErrorNoChoseVolumeFileModal();
@@ -357,12 +395,44 @@ void GUI::TransferFunctionRender() {
 
         // Volume Rendering Setting (Ray Casting)
         if (state.world->my_volume) {
+            const Volume& volume = *state.world->my_volume;
+            char texture_memory[32];
+            MemoryUsage::FormatBytes(volume.GetTextureBytes(volume.m_layout), texture_memory, sizeof(texture_memory));
+            ImGui::Text("Texture Memory: %s (%s)", texture_memory, layout_items[static_cast<int>(volume.m_layout)]);
             ImGui::SliderFloat("Camera Distance", &state.world->my_camera->distance, 400.0f, 1200.0f);
             ImGui::SliderFloat("Sample rate", &state.world->sample_rate, 0.1f, 1.0f);
             ImGui::Checkbox("Normal Color", &state.world->use_normal_color);
             ImGui::Checkbox("Lighting", &state.world->use_lighting);
+            ImGui::Checkbox("Empty Space Skipping", &state.world->use_empty_space_skipping);
+            ImGui::SameLine();
+            ImGui::Text("(%zu / %zu bricks visible)", volume.m_bricks.GetOccupiedCount(), volume.m_bricks.GetBrickCount());
+            ImGui::Checkbox("Slab Ray Setup", &state.world->use_slab_ray_setup);
+            ImGui::Checkbox("Opacity Correction", &state.world->use_opacity_correction);
+            ImGui::Checkbox("Adaptive Sampling", &state.world->use_adaptive_sampling);
+            if (state.world->use_adaptive_sampling) {
+                ImGui::SliderFloat("Max Step Scale", &state.world->adaptive_max_step_scale, 1.0f, 8.0f);
+                ImGui::SliderFloat("Importance Threshold", &state.world->adaptive_importance_threshold, 0.01f, 1.0f);
+            }
+            ImGui::Checkbox("Ray Statistics", &state.world->use_ray_statistics);
+            if (state.world->use_ray_statistics) {
+                ImGui::Text("Average Samples per Ray: %.1f", state.world->average_samples_per_ray);
+            }
+            ImGui::Checkbox("Render on Demand", &state.world->render_on_demand);
+            ImGui::SameLine();
+            ImGui::Text("(%zu frames skipped)", state.world->skipped_frames);
+            QualityScheduler& quality = state.world->quality;
+            ImGui::Checkbox("Progressive Refinement", &quality.enabled);
+            if (quality.enabled) {
+                ImGui::SliderFloat("Target Frame Time (ms)", &quality.target_frame_time, 8.0f, 100.0f);
+                ImGui::Text("Volume Resolution: %s%s", quality.ShowLevel(), quality.IsInteracting() ? " (interacting)" : "");
+            }
+            ImGui::Checkbox("Pre-Integrated Classification", &state.world->use_preintegration);
+            ImGui::SameLine();
+            ImGui::Text("(%dx%d table, %.2f ms)", volume.m_preintegration.m_size, volume.m_preintegration.m_size,
+                        volume.m_preintegration.m_build_cost.count() * 1000.0);
             if (m_transfer_function.DrawUI("Transfer Function", 256)) {
                 state.world->my_volume->GenerateTFTexture(m_transfer_function);
+                state.world->quality.Invalidate();
             }
         }
         ImGui::Spacing();
@@ -379,6 +449,104 @@ void GUI::CubicBezierRender() {
     }
 }
 
+void GUI::ProfilerRender() {
+    if (Windows.Profiler.Visible) {
+        ImGui::SetNextWindowSize(ImVec2(520, 480), ImGuiCond_Once);
+        ImGui::Begin("Profiler", &Windows.Profiler.Visible, Windows.Profiler.WindowFlags);
+        ::Profiler& profiler = ::Profiler::Shared();
+        ImGui::Checkbox("Record", &profiler.enabled);
+        ImGui::SameLine();
+        if (ImGui::Button("Clear")) {
+            profiler.Clear();
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Export Chrome Trace")) {
+            profiler.WriteChromeTrace("profile_trace.json");
+        }
+
+        // Heap allocations of the whole frame, with or without recording
+        if (AllocationCounter::IsEnabled()) {
+            const AllocationCounter::Totals allocations = AllocationCounter::LastFrame();
+            ImGui::Text("Heap Allocations: %llu (%llu bytes) last frame, %llu frames allocated",
+                        static_cast<unsigned long long>(allocations.count), static_cast<unsigned long long>(allocations.bytes),
+                        static_cast<unsigned long long>(AllocationCounter::AllocatingFrames()));
+        } else {
+            ImGui::TextDisabled("Heap Allocations: build with VOLUME_RENDERER_COUNT_ALLOCATIONS to count them");
+        }
+
+        const std::size_t frame_count = profiler.FrameCount();
+        if (frame_count == 0) {
+            ImGui::TextDisabled("No frame recorded yet.");
+            ImGui::End();
+            return;
+        }
+
+        // Frame time over the history
+        m_profiler_plot.clear();
+        for (std::size_t i = 0; i < frame_count; i++) {
+            m_profiler_plot.push_back(static_cast<float>(profiler.GetFrame(i).cpu_ms));
+        }
+        const ::Profiler::Frame& last = profiler.GetFrame(frame_count - 1);
+        char overlay[64];
+        std::snprintf(overlay, sizeof(overlay), "CPU %.2f ms, GPU %.2f ms", last.cpu_ms, last.gpu_ms);
+        ImGui::PlotLines("##frame_times", m_profiler_plot.data(), static_cast<int>(m_profiler_plot.size()), 0, overlay,
+                         0.0f, FLT_MAX, ImVec2(ImGui::GetContentRegionAvail().x, 60.0f));
+        ImGui::Spacing();
+
+        // Flame graph of the CPU timeline of the last frame, one row per depth
+        int max_depth = 0;
+        for (const auto& sample : last.samples) {
+            max_depth = std::max(max_depth, sample.depth);
+        }
+        auto* draw_list = ImGui::GetWindowDrawList();
+        const ImVec2 origin = ImGui::GetCursorScreenPos();
+        const float width = ImGui::GetContentRegionAvail().x;
+        const float row_height = Windows.Profiler.RowHeight;
+        const float scale = last.cpu_ms > 0.0 ? width / static_cast<float>(last.cpu_ms) : 0.0f;
+        ImGui::InvisibleButton("##flame", ImVec2(width, row_height * static_cast<float>(max_depth + 1)));
+
+        for (const auto& sample : last.samples) {
+            const ImVec2 min(origin.x + static_cast<float>(sample.cpu_begin_ms) * scale, origin.y + static_cast<float>(sample.depth) * row_height);
+            const ImVec2 max(min.x + std::max(static_cast<float>(sample.cpu_ms) * scale, 1.0f), min.y + row_height - 1.0f);
+            // GPU scopes are blue, CPU only scopes are grey.
+            const ImU32 color = sample.gpu_ms >= 0.0 ? ImColor(70, 110, 170) : ImColor(110, 110, 110);
+            draw_list->AddRectFilled(min, max, color);
+            draw_list->PushClipRect(min, max, true);
+            draw_list->AddText(ImVec2(min.x + 3.0f, min.y + 2.0f), ImGui::GetColorU32(ImGuiCol_Text), sample.name);
+            draw_list->PopClipRect();
+
+            if (ImGui::IsMouseHoveringRect(min, max)) {
+                if (sample.gpu_ms >= 0.0) {
+                    ImGui::SetTooltip("%s\nCPU %.3f ms\nGPU %.3f ms", sample.name, sample.cpu_ms, sample.gpu_ms);
+                } else {
+                    ImGui::SetTooltip("%s\nCPU %.3f ms", sample.name, sample.cpu_ms);
+                }
+            }
+        }
+        ImGui::Spacing();
+
+        // Averages over the history
+        profiler.Averages(m_profiler_averages);
+        ImGui::Columns(3, "profiler_columns");
+        ImGui::Text("Scope"); ImGui::NextColumn();
+        ImGui::Text("CPU (ms)"); ImGui::NextColumn();
+        ImGui::Text("GPU (ms)"); ImGui::NextColumn();
+        ImGui::Separator();
+        for (const auto& average : m_profiler_averages) {
+            ImGui::Text("%*s%s", average.depth * 2, "", average.name); ImGui::NextColumn();
+            ImGui::Text("%.3f", average.cpu_ms); ImGui::NextColumn();
+            if (average.gpu_ms >= 0.0) {
+                ImGui::Text("%.3f", average.gpu_ms);
+            } else {
+                ImGui::TextDisabled("-");
+            }
+            ImGui::NextColumn();
+        }
+        ImGui::Columns(1);
+        ImGui::End();
+    }
+}
+
 void GUI::SettingsRender() {
     // Settings Window Render
     if (Windows.Settings.Visible) {
@@ -387,6 +555,15 @@ void GUI::SettingsRender() {
         ImGui::Checkbox("Draw Axes ", &state.world->draw_axes);
         ImGui::Checkbox("Back Face Culling", &state.world->culling);
         ImGui::Spacing();
+
+        // Not while a volume is being loaded (Resize() waits for the chunks the workers are running), cancelled loads are fine.
+        state.world->worker_threads = static_cast<int>(ThreadPool::Shared().Size());
+        if (ImGui::SliderInt("Worker Threads", &state.world->worker_threads, 1, static_cast<int>(ThreadPool::HardwareThreads()))) {
+            if (!state.world->volume_loader.IsBusy()) {
+                ThreadPool::Shared().Resize(state.world->worker_threads);
+            }
+        }
+        ImGui::Spacing();
         const char* items_a[] = { "Normal", "Inversion", "Grayscale", "Narcotic", "Blur", "Edge Detection" };
         ImGui::Combo("Screen Mode", reinterpret_cast<int*>(&state.world->current_screen_mode), items_a, IM_ARRAYSIZE(items_a));
         ImGui::Checkbox("Gamma Correction", &state.world->use_gamma_correction);
@@ -403,6 +580,27 @@ void GUI::SettingsRender() {
             }
         }
         ImGui::Spacing();
+
+        // GPU memory of the textures in the TextureManager (the volume textures are shown in the Volume Settings)
+        char bytes[32];
+        MemoryUsage::FormatBytes(TextureManager::GetGPUBytes(TextureKind::RENDER_TARGET), bytes, sizeof(bytes));
+        if (ImGui::TreeNode("render_targets", "Render Targets: %s", bytes)) {
+            const RenderTargetPool::Counters& counters = RenderTargetPool::Shared().GetCounters();
+            MemoryUsage::FormatBytes(counters.allocated_bytes, bytes, sizeof(bytes));
+            ImGui::Text("Allocations: %zu (%s), %zu reuses", counters.allocations, bytes, counters.reuses);
+            ImGui::Text("Frame Graph: %d of %d passes live", state.world->frame_graph_live_passes, state.world->frame_graph_passes);
+            for (const TextureInfo& info : TextureManager::GetTextureInfos()) {
+                if (!info.alive || info.kind != TextureKind::RENDER_TARGET) {
+                    continue;
+                }
+                MemoryUsage::FormatBytes(info.bytes, bytes, sizeof(bytes));
+                ImGui::Text("%s: %d x %d, %s", info.name.c_str(), info.width, info.height, bytes);
+            }
+            ImGui::TreePop();
+        }
+        MemoryUsage::FormatBytes(TextureManager::GetGPUBytes(TextureKind::TEXTURE_2D) + TextureManager::GetGPUBytes(TextureKind::CUBE_MAP),
+                                 bytes, sizeof(bytes));
+        ImGui::Text("Image Textures: %s", bytes);
         ImGui::End();
     }
 }
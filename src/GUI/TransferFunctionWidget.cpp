@@ -6,6 +6,10 @@
 #include <iostream>
 #include <cassert>
 
+#include <toml++/toml.h>
+
+#include "Utility/Logger.hpp"
+
 // Some helper function
 template <typename T>
 inline T clamp(T x, T min, T max) {
@@ -46,11 +50,17 @@ TransferFunctionWidget::TransferFunctionWidget() :
     m_current_channel(static_cast<std::size_t>(Channel::Alpha)),
     m_current_control_pt(0) {
     InitialControlPoints();
+    ResizeColormap();
 }
 
-bool TransferFunctionWidget::DrawUI(const std::string& label, const int& domain) {
+bool TransferFunctionWidget::DrawUI(const char* label, const int& domain) {
+    // Assigning keeps the capacity of m_label, a std::string parameter would be built from the literal every frame.
     m_label = label;
-    m_domain = domain;
+    m_changed = TexelRange();
+    if (m_domain != domain) {
+        m_domain = domain;
+        ResizeColormap();
+    }
 
     ImGui::Text("%s", m_label.c_str());
     ImGui::TextWrapped(
@@ -74,26 +84,119 @@ bool TransferFunctionWidget::DrawUI(const std::string& label, const int& domain)
     return HandleEvents();
 }
 
-std::vector<float> TransferFunctionWidget::GetColorData() const {
-    std::vector<float> results(m_domain * 4, 0.0f);
+const std::vector<float>& TransferFunctionWidget::GetColorData() const {
+    return m_colormap;
+}
+
+const TransferFunctionWidget::TexelRange& TransferFunctionWidget::GetChangedRange() const {
+    return m_changed;
+}
+
+std::size_t TransferFunctionWidget::GetVersion() const {
+    return m_version;
+}
+
+void TransferFunctionWidget::ResizeColormap() {
+    m_colormap.assign(static_cast<std::size_t>(m_domain) * 4, 0.0f);
     for (std::size_t channel = 0; channel < m_control_pts.size(); channel++) {
-        auto current_control_pt = m_control_pts[channel].begin();
-        for (size_t i = 0; i < m_domain; i++) {
-            float x = static_cast<float>(i) / static_cast<float>(m_domain);
-            auto upper = current_control_pt + 1;
-            if (x > upper->x) {
-                current_control_pt++;
-                upper++;
+        UpdateColormap(channel, 0.0f, 1.0f);
+    }
+}
+
+/**
+ * Re-interpolate one channel of the colormap where x is in [x_min, x_max]
+ *
+ * 控制點移動、新增或刪除時，只有它左右兩個鄰居之間的線段會改變，所以傳入鄰居的 x 即可。
+ *
+ * @param channel The channel of the edited control points
+ * @param x_min The lower bound of the edited segments, in canvas coordinates
+ * @param x_max The upper bound of the edited segments, in canvas coordinates
+ */
+void TransferFunctionWidget::UpdateColormap(std::size_t channel, float x_min, float x_max) {
+    const std::vector<ImVec2>& pts = m_control_pts[channel];
+    const float domain = static_cast<float>(m_domain);
+    const int begin = clamp(static_cast<int>(std::floor(x_min * domain)), 0, m_domain);
+    const int end = clamp(static_cast<int>(std::ceil(x_max * domain)) + 1, 0, m_domain);
+    if (begin >= end || pts.size() < 2) {
+        return;
+    }
+
+    // The segment of the first texel, the first control point at or after x (same as walking from x = 0).
+    const float x_begin = static_cast<float>(begin) / domain;
+    auto upper = std::lower_bound(pts.begin() + 1, pts.end() - 1, x_begin,
+                                  [](const ImVec2& point, float x) { return point.x < x; });
+    for (int i = begin; i < end; i++) {
+        float x = static_cast<float>(i) / domain;
+        while (x > upper->x && upper + 1 != pts.end()) {
+            upper++;
+        }
+        const auto lower = upper - 1;
+
+        // Doing lerp
+        const float width = upper->x - lower->x;
+        float t = width > 0.0f ? (x - lower->x) / width : 1.0f;
+        float value = (1.0f - t) * lower->y + t * upper->y;
+        m_colormap[static_cast<std::size_t>(i) * 4 + channel] = clamp(value, 0.0f, 1.0f);
+    }
+
+    if (m_changed.Empty()) {
+        m_changed.begin = begin;
+        m_changed.end = end;
+    } else {
+        m_changed.begin = std::min(m_changed.begin, begin);
+        m_changed.end = std::max(m_changed.end, end);
+    }
+    m_changed.channels |= 1u << channel;
+    m_version++;
+}
+
+bool TransferFunctionWidget::LoadPreset(const std::string& file_path) {
+    toml::table tbl;
+    try {
+        tbl = toml::parse_file(file_path);
+    } catch (const toml::parse_error& err) {
+        Logger::Message(LogLevel::Error, "Failed to parsing transfer function preset (TOML) at file: " + file_path + "\n reason: \n" + std::string(err.description()) + "\n");
+        return false;
+    }
+
+    const std::array<std::string, 4> channel_names = {"red", "green", "blue", "alpha"};
+    std::array<std::vector<ImVec2>, 4> control_pts;
+    for (std::size_t channel = 0; channel < channel_names.size(); channel++) {
+        const toml::array* points = tbl[channel_names[channel]].as_array();
+        if (points == nullptr) {
+            Logger::Message(LogLevel::Error, "The transfer function preset has no \"" + channel_names[channel] + "\" channel: " + file_path);
+            return false;
+        }
+
+        for (const auto& point : *points) {
+            const toml::array* xy = point.as_array();
+            if (xy == nullptr || xy->size() != 2) {
+                Logger::Message(LogLevel::Error, "Control points must be [x, y] pairs, channel \"" + channel_names[channel] + "\": " + file_path);
+                return false;
             }
+            const float x = clamp((*xy)[0].value_or(0.0f), 0.0f, 1.0f);
+            const float y = clamp((*xy)[1].value_or(0.0f), 0.0f, 1.0f);
+            control_pts[channel].emplace_back(x, y);
+        }
 
-            // Doing lerp
-            float t = (x - current_control_pt->x) / (upper->x - current_control_pt->x);
-            float value = (1.0f - t) * current_control_pt->y + t * upper->y;
-            results[i * 4 + channel] = clamp(value, 0.0f, 1.0f);
+        // GetColorData() walks the points from x = 0 to x = 1.
+        auto& pts = control_pts[channel];
+        std::sort(pts.begin(), pts.end(), [](const ImVec2& a, const ImVec2& b) { return a.x < b.x; });
+        if (pts.empty() || pts.front().x > 0.0f) {
+            pts.insert(pts.begin(), ImVec2(0.0f, pts.empty() ? 0.0f : pts.front().y));
+        }
+        if (pts.back().x < 1.0f) {
+            pts.emplace_back(1.0f, pts.back().y);
         }
     }
 
-    return results;
+    m_control_pts = control_pts;
+    m_current_control_pt = 0;
+    m_colormap_change = true;
+    for (std::size_t channel = 0; channel < m_control_pts.size(); channel++) {
+        UpdateColormap(channel, 0.0f, 1.0f);
+    }
+    return true;
 }
 
 void TransferFunctionWidget::InitialControlPoints() {
@@ -260,7 +363,10 @@ bool TransferFunctionWidget::HandleEvents() {
     if (m_is_handle_captured) {
         if (is_right_clicked) {
             if (m_current_control_pt != 0 && m_current_control_pt != active.size() - 1) {
+                const float x_min = active[m_current_control_pt - 1].x;
+                const float x_max = active[m_current_control_pt + 1].x;
                 active.erase(active.begin() + m_current_control_pt);
+                UpdateColormap(m_current_channel, x_min, x_max);
                 m_is_handle_captured = false;
                 m_colormap_change = true;
             }
@@ -287,6 +393,7 @@ bool TransferFunctionWidget::HandleEvents() {
             }
 
             active[m_current_control_pt] = pos_next;
+            UpdateColormap(m_current_channel, x_min, x_max);
             m_colormap_change = true;
         }
     } else if (is_right_clicked && active.size() < m_config.control_pt_count_max) {
@@ -294,8 +401,11 @@ bool TransferFunctionWidget::HandleEvents() {
         if (mouse_pos.x > 0.0f && mouse_pos.x < 1.0f && mouse_pos.y > 0.0f && mouse_pos.y < 1.0f) {
             active.emplace_back(mouse_pos);
             std::sort(active.begin(), active.end(), [](const auto& a, const auto& b) { return a.x < b.x; });
+            // The new point splits the segment it falls on.
+            const auto inserted = std::find_if(active.begin(), active.end(), [&](const ImVec2& p) { return p.x == mouse_pos.x && p.y == mouse_pos.y; });
+            UpdateColormap(m_current_channel, (inserted - 1)->x, (inserted + 1)->x);
+            m_colormap_change = true;
         }
-        m_colormap_change = true;
     }
 
     return m_colormap_change;
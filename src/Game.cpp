@@ -1,59 +1,278 @@
 #include "Game.hpp"
 
+#include <algorithm>
+#include <cmath>
+
 #include "Texture/TextureManager.hpp"
 #include "State.hpp"
 #include "Utility/Logger.hpp"
+#include "Utility/Profiler.hpp"
 
 Game::Game() {
+    // clear() keeps the capacity, so polling only allocates when a frame gets more events than any frame before.
+    events.reserve(64);
+
     // Create Renderer
     master_renderer = std::make_unique<MasterRenderer>();
 
     // Create World
     state.world = std::make_unique<World>();
     state.world->Create();
+    master_renderer->WarmUp();
+
+    // Targets of the scene, the storage is rounded up to the bucket of the RenderTargetPool
+    RenderTargetPool& pool = RenderTargetPool::Shared();
+    const char* main_names[] = { "PostProcessing", "RayStatistics" };
+    const char* reduced_names[] = { "ReducedPostProcessing", "ReducedRayStatistics" };
+    for (int i = 0; i < 2; i++) {
+        main_targets[i] = pool.Create(main_names[i], state.window->width, state.window->height);
+    }
+    for (int i = 0; i < 2; i++) {
+        reduced_targets[i] = pool.Create(reduced_names[i], main_targets[0].allocated_width / 2, main_targets[0].allocated_height / 2);
+    }
+    UpdateRenderSize();
+    settled_width = render_width;
+    settled_height = render_height;
 
     // Create Framebuffer and Renderbuffer for Post Processing and HDR
-    main_renderbuffer = std::make_unique<RenderBuffer>(state.window->width, state.window->height);
+    // Attachment 1 stays empty until the frame graph has a bloom pass, BrightColor is not written before that.
+    const unsigned int attachments[] = { 0, 2 };
+    main_renderbuffer = std::make_unique<RenderBuffer>(main_targets[0].allocated_width, main_targets[0].allocated_height);
     main_framebuffer = std::make_unique<FrameBuffer>();
-    main_framebuffer->BindTexture2D(TextureManager::GetTexture2D("PostProcessing"), 0);
-    main_framebuffer->BindTexture2D(TextureManager::GetTexture2D("Bloom"), 1);
+    for (int i = 0; i < 2; i++) {
+        main_framebuffer->BindTexture2D(TextureManager::GetTexture2D(main_targets[i].texture), attachments[i]);
+    }
     main_framebuffer->BindRenderBuffer(main_renderbuffer);
-    main_framebuffer->SetDrawBufferAmount(2);
+    main_framebuffer->SetDrawBuffers({ true, false, true });
     main_framebuffer->CheckComplete();
 
-    // Create Framebuffer for Gaussian Blur
-    for (int i = 0; i < gaussian_blur_framebuffer.size(); i++) {
-        gaussian_blur_framebuffer[i] = std::make_unique<FrameBuffer>();
-        gaussian_blur_framebuffer[i]->BindTexture2D(TextureManager::GetTexture2D("GaussianBlur" + std::to_string(i)), 0);
-        gaussian_blur_framebuffer[i]->CheckComplete();
+    reduced_framebuffer = std::make_unique<FrameBuffer>();
+    for (int i = 0; i < 2; i++) {
+        reduced_framebuffer->BindTexture2D(TextureManager::GetTexture2D(reduced_targets[i].texture), attachments[i]);
+    }
+    reduced_framebuffer->SetDrawBuffers({ true, false, true });
+    reduced_framebuffer->CheckComplete();
+}
+
+bool Game::FrameGraphKey::Differs(const FrameGraphKey& other) const {
+    return use_bloom != other.use_bloom || bloom_method != other.bloom_method || bloom_strength != other.bloom_strength
+           || bloom_mip_levels != other.bloom_mip_levels || width != other.width || height != other.height;
+}
+
+bool Game::PrepareFrameGraph() {
+    const World& world = *state.world;
+    const FrameGraphKey key { world.use_bloom, world.current_bloom_method, world.bloom_strength, world.bloom_mip_levels, settled_width, settled_height };
+    if (has_frame_graph && !key.Differs(frame_graph_key)) {
+        // 拖曳視窗時只改 target 的大小，不重建整個 graph
+        if (render_width == frame_graph_width && render_height == frame_graph_height) {
+            return false;
+        }
+        ResizeFrameGraph();
+        return true;
     }
+
+    frame_graph_key = key;
+    has_frame_graph = true;
+    BuildFrameGraph();
+    return true;
+}
+
+void Game::ResizeFrameGraph() {
+    frame_graph_width = render_width;
+    frame_graph_height = render_height;
+    for (const SizedResource& sized : sized_resources) {
+        const int width = sized.level < 0 ? render_width : BloomRenderer::LevelWidth(sized.level, render_width);
+        const int height = sized.level < 0 ? render_height : BloomRenderer::LevelHeight(sized.level, render_height);
+        frame_graph.Resize(sized.resource, width, height);
+    }
+}
+
+void Game::BuildFrameGraph() {
+    // 兩種 bloom 的 pass 都宣告，只有被 screen pass 讀到的那一條會留下來，其他的在 Compile() 被剔除
+    frame_graph.Clear();
+    sized_resources.clear();
+    World& world = *state.world;
+    const int width = render_width, height = render_height;
+    frame_graph_width = width;
+    frame_graph_height = height;
+    const bool is_mip_chain = world.current_bloom_method == BloomMethod::MIP_CHAIN;
+
+    const FrameResource scene = frame_graph.Import("PostProcessing", &main_targets[0]);
+    const FrameResource ray_statistics = frame_graph.Import("RayStatistics", &main_targets[1]);
+    // Without a blur pass the screen reads the attachment itself
+    bright = frame_graph.Create("Bloom", width, height, !is_mip_chain && world.bloom_strength <= 0);
+    sized_resources.push_back({ bright, -1 });
+
+    frame_graph.AddPass("Scene", FrameStage::Scene, {}, { scene, bright, ray_statistics }, [this]() {
+        RendererInit();
+        Render(state.world->my_camera);
+    });
+
+    // Gaussian blur: every iteration writes a new resource, the aliasing of their lifetimes makes it a ping-pong of two targets
+    FrameResource blurred = bright;
+    bool is_horizontal = true;
+    for (int i = 0; i < world.bloom_strength; i++) {
+        const char* name = is_horizontal ? "Blur Horizontal" : "Blur Vertical";
+        const FrameResource source = blurred;
+        blurred = frame_graph.Create(name, width, height, !is_mip_chain && i == world.bloom_strength - 1);
+        sized_resources.push_back({ blurred, -1 });
+        frame_graph.AddPass(name, FrameStage::Bloom, { source }, { blurred }, [this, name, source, target = blurred, is_horizontal]() {
+            ProfileScope pass(name);
+            BindFrameTarget(target);
+            master_renderer->GaussianBlur(is_horizontal, frame_graph.Target(source));
+        });
+        is_horizontal = !is_horizontal;
+    }
+
+    // Mip chain: every level is the filtered half of the one before, then the blurred smaller level is added onto the larger one
+    const int depth = BloomRenderer::ChainDepth(world.bloom_mip_levels, width, height);
+    std::array<FrameResource, BloomRenderer::MaxLevels> levels {};
+    for (int level = 0; level < depth; level++) {
+        levels[level] = frame_graph.Create("Bloom Mip", BloomRenderer::LevelWidth(level, width), BloomRenderer::LevelHeight(level, height),
+                                           is_mip_chain && level == 0);
+        sized_resources.push_back({ levels[level], level });
+        const FrameResource source = level == 0 ? bright : levels[level - 1];
+        frame_graph.AddPass("Downsample", FrameStage::Bloom, { source }, { levels[level] }, [this, source, target = levels[level]]() {
+            ProfileScope pass("Downsample");
+            BindFrameTarget(target);
+            master_renderer->BloomDownsample(frame_graph.Target(source));
+        });
+    }
+    for (int level = depth - 2; level >= 0; level--) {
+        const FrameResource source = levels[level + 1];
+        frame_graph.AddPass("Upsample", FrameStage::Bloom, { source, levels[level] }, { levels[level] }, [this, source, target = levels[level]]() {
+            ProfileScope pass("Upsample");
+            BindFrameTarget(target);
+            glBlendFunc(GL_ONE, GL_ONE);
+            master_renderer->BloomUpsample(frame_graph.Target(source));
+            glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        });
+    }
+
+    // 確保是 off-screen rendering，在預設的 framebuffer 上渲染才會看得見
+    if (world.use_bloom) {
+        const FrameResource bloom = is_mip_chain ? levels[0] : blurred;
+        frame_graph.AddPass("Screen", FrameStage::Screen, { scene, bloom }, {}, [this, scene, bloom]() {
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+            master_renderer->RenderScreen(frame_graph.Target(scene), &frame_graph.Target(bloom));
+        }, true);
+    } else {
+        frame_graph.AddPass("Screen", FrameStage::Screen, { scene }, {}, [this, scene]() {
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+            master_renderer->RenderScreen(frame_graph.Target(scene), nullptr);
+        }, true);
+    }
+
+    frame_graph.Compile();
+    world.frame_graph_passes = frame_graph.PassCount();
+    world.frame_graph_live_passes = frame_graph.LivePassCount();
+}
+
+void Game::BindFrameTarget(FrameResource resource) {
+    const RenderTarget& target = frame_graph.Target(resource);
+    frame_graph.Framebuffer(resource).Bind();
+    glViewport(0, 0, target.width, target.height);
+}
+
+void Game::AttachTargets(FrameBuffer& framebuffer, TextureHandle bloom, AttachedTargets& attached) {
+    // The pool hands out the same target every frame, so this changes only with the graph (or after a trim)
+    const bool ray_statistics = state.world->use_ray_statistics;
+    if (bloom.index == attached.bloom.index && bloom.generation == attached.bloom.generation && ray_statistics == attached.ray_statistics) {
+        return;
+    }
+    if (bloom.index != attached.bloom.index || bloom.generation != attached.bloom.generation) {
+        if (bloom.IsValid()) {
+            framebuffer.BindTexture2D(TextureManager::GetTexture2D(bloom), 1);
+        } else {
+            framebuffer.DetachTexture2D(1);
+        }
+    }
+    framebuffer.SetDrawBuffers({ true, bloom.IsValid(), ray_statistics });
+    attached.bloom = bloom;
+    attached.ray_statistics = ray_statistics;
 }
 
 void Game::RendererInit() {
     // 在每一次的 Game loop 都會執行，且在分割畫面之前
+    AttachTargets(*main_framebuffer, frame_graph.IsRealized(bright) ? frame_graph.Texture(bright) : TextureHandle {}, main_attached);
     main_framebuffer->Bind();
     master_renderer->Initialize();
+
+    // The statistics are written as they are: cleared to zero and never blended.
+    if (state.world->use_ray_statistics) {
+        const GLfloat zero[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+        glClearBufferfv(GL_COLOR, 2, zero);
+        glDisablei(GL_BLEND, 2);
+    }
+    ray_statistics_target = &main_targets[1];
 }
 
-void Game::RenderGaussianBlur() {
-    if (state.world->use_bloom) {
-        bool is_horizontal = true, first_iteration = true;
-        for (int i = 0; i < state.world->bloom_strength; i++) {
-            gaussian_blur_framebuffer[is_horizontal]->Bind();
-            master_renderer->GaussianBlur(is_horizontal, first_iteration);
-            is_horizontal = !is_horizontal;
-            if (first_iteration) {
-                first_iteration = false;
-            }
+void Game::UpdateRayStatistics(bool scene_rendered) {
+    // 上一次的 read back 完成了才讀取，不等待 GPU
+    if (ray_statistics_fence != nullptr) {
+        const GLenum status = glClientWaitSync(ray_statistics_fence, 0, 0);
+        if (status == GL_TIMEOUT_EXPIRED) {
+            return;
         }
+        glDeleteSync(ray_statistics_fence);
+        ray_statistics_fence = nullptr;
+
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, ray_statistics_buffer);
+        const void* mapped = status != GL_WAIT_FAILED ? glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, 3 * sizeof(GLfloat), GL_MAP_READ_BIT) : nullptr;
+        if (mapped != nullptr) {
+            const auto* mean = static_cast<const GLfloat*>(mapped);
+            state.world->average_samples_per_ray = mean[1] > 0.0f ? mean[0] / mean[1] : 0.0f;
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
     }
+
+    if (!scene_rendered || !state.world->use_ray_statistics || ray_statistics_target == nullptr) {
+        return;
+    }
+    if (++frames_since_ray_statistics < RayStatisticsInterval) {
+        return;
+    }
+    frames_since_ray_statistics = 0;
+    ReadRayStatistics(*ray_statistics_target);
 }
 
-void Game::RenderScreen() {
-    // 確保是 off-screen rendering，在預設的 framebuffer 上渲染才會看得見
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+void Game::ReadRayStatistics(const RenderTarget& target) {
+    ProfileScope scope("Ray Statistics");
+    if (ray_statistics_buffer == 0) {
+        glGenBuffers(1, &ray_statistics_buffer);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, ray_statistics_buffer);
+        glBufferData(GL_PIXEL_PACK_BUFFER, 3 * sizeof(GLfloat), nullptr, GL_STREAM_READ);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    }
+
+    // The last mipmap level is the mean over the screen: (samples, covered pixels) per pixel, their ratio is per ray.
+    // The texels past the drawn part are cleared to zero every frame, the ratio is the same over the whole storage.
+    // With a pack buffer bound glGetTexImage only queues the copy, the fence tells when it is done.
+    const Texture2D& statistics = TextureManager::GetTexture2D(target.texture);
+    statistics.Bind();
+    glGenerateMipmap(GL_TEXTURE_2D);
+    const int last_level = static_cast<int>(std::floor(std::log2(static_cast<float>(std::max(target.allocated_width, target.allocated_height)))));
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, ray_statistics_buffer);
+    glGetTexImage(GL_TEXTURE_2D, last_level, GL_RGB, GL_FLOAT, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    statistics.UnBind();
+    ray_statistics_fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+void Game::RenderScene() {
+    frame_graph.Execute(FrameStage::Scene);
+}
 
-    master_renderer->RenderScreen();
+void Game::RenderBloom() {
+    // Each pass is timed on the GPU on its own, GL_TIME_ELAPSED queries can not be nested.
+    ProfileScope scope("Bloom", false);
+    frame_graph.Execute(FrameStage::Bloom);
+    glViewport(0, 0, state.window->width, state.window->height);
+}
+
+void Game::RenderScreen() {
+    frame_graph.Execute(FrameStage::Screen);
 }
 
 void Game::Update(float dt) {
@@ -66,14 +285,68 @@ void Game::Update(float dt) {
 
     // Update the spotlight
     state.world->my_point_light->Update(dt);
+
+    // 畫面有沒有在變動，決定這個 frame 的 volume 解析度
+    state.world->quality.ObserveCamera(state.world->my_camera->View());
+
+    // 背景讀取的 volume 完成後，在這裡（GL thread）上傳到 GPU 並替換掉舊的 volume
+    if (auto volume = state.world->volume_loader.TakeResult()) {
+        volume->Upload();
+        volume->GenerateTFTexture(state.ui->m_transfer_function);
+        state.world->my_volume = std::move(volume);
+    }
 }
 
 void Game::Render(const std::unique_ptr<Camera>& current_camera) {
     // 基本上就是每一偵都會執行此函數，如果說畫面有切割的話，那同一次 Game loop 之中會 repeat 多次。
-    master_renderer->Render(current_camera);
+    master_renderer->PrepareFrame(current_camera);
+    const int divisor = state.world->quality.Divisor();
+    if (divisor == 1 || !state.world->my_volume) {
+        master_renderer->Render(current_camera);
+        return;
+    }
+
+    // 操作中：volume 先畫在縮小的 target 再放大到 main framebuffer，三軸仍然以完整解析度繪製
+    const auto& viewport = current_camera->viewport;
+    const int width = std::max(viewport.width / divisor, 1);
+    const int height = std::max(viewport.height / divisor, 1);
+    RenderTargetPool& pool = RenderTargetPool::Shared();
+    const bool use_bloom = frame_graph.IsRealized(bright);
+    const TransientTarget reduced_bloom = use_bloom ? pool.Acquire(width, height) : -1;
+    AttachTargets(*reduced_framebuffer, use_bloom ? pool.Target(reduced_bloom).texture : TextureHandle {}, reduced_attached);
+    reduced_framebuffer->Bind();
+    glViewport(0, 0, width, height);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    if (state.world->use_ray_statistics) {
+        const GLfloat zero[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+        glClearBufferfv(GL_COLOR, 2, zero);
+    }
+    master_renderer->RenderVolume(current_camera);
+
+    // The statistics are read from the reduced target itself, a stretched copy would only blur them
+    for (unsigned int attachment = 0; attachment < 2; attachment++) {
+        if (attachment != 1 || use_bloom) {
+            reduced_framebuffer->BlitColor(*main_framebuffer, attachment, width, height, viewport.width, viewport.height);
+        }
+    }
+    ray_statistics_target = &reduced_targets[1];
+    if (reduced_bloom >= 0) {
+        pool.Release(reduced_bloom);
+    }
+
+    main_framebuffer->Bind();
+    current_camera->SetViewPort();
+    master_renderer->RenderAxes(current_camera);
 }
 
 void Game::Destroy() {
+    if (ray_statistics_fence != nullptr) {
+        glDeleteSync(ray_statistics_fence);
+        ray_statistics_fence = nullptr;
+    }
+    glDeleteBuffers(1, &ray_statistics_buffer);
+    frame_graph.Clear();
+    RenderTargetPool::Shared().Destroy();
     state.world->Destroy();
 }
 
@@ -90,6 +363,12 @@ void Game::HandleEvents() {
         ProcessEvents(*it, state.ui->WantCaptureEvent);
     }
 
+    // 視窗大小已經穩定
+    if (resize_pending && SDL_GetTicks() - resize_time >= ResizeDelay) {
+        resize_pending = false;
+        UpdateFramebuffer();
+    }
+
     // 如果 ImGui 佔用了滑鼠與鍵盤時，就不會執行下面的事件控制
 //    if (state.ui->WantCaptureEvent) {
 //        return;
@@ -100,6 +379,18 @@ void Game::HandleEvents() {
     state.world->me->HandleEvents();
 }
 
+bool Game::HasEvents() const {
+    return !events.empty() || resize_pending;
+}
+
+int Game::RenderWidth() const {
+    return render_width;
+}
+
+int Game::RenderHeight() const {
+    return render_height;
+}
+
 void Game::PollEvents() {
     events.clear();
 
@@ -155,8 +446,10 @@ void Game::GlobalEvents(const SDL_Event &event) {
                 // 更新視窗長寬
                 SDL_GetWindowSize(state.window->handler, &state.window->width, &state.window->height);
 
-                // 更新 Framebuffer Texture 和 Renderer buffer
-                UpdateFramebuffer();
+                // Framebuffer Texture 和 Renderer buffer 等到大小穩定之後再更新，在那之前畫在現有的 storage 裡
+                resize_pending = true;
+                resize_time = SDL_GetTicks();
+                UpdateRenderSize();
             }
             break;
     }
@@ -229,23 +522,34 @@ void Game::OnWindowEvent(const SDL_WindowEvent& e) {
 }
 
 void Game::UpdateFramebuffer() {
-    // 當視窗大小改變時，每次都必須要重新更改 Texture 與 Renderbuffer 的大小
-    main_renderbuffer->Resize(state.window->width, state.window->height);
-
-    Texture2D screen = TextureManager::GetTexture2D("PostProcessing");
-    screen.Bind();
-    screen.Generate(GL_RGB16F, GL_RGB, state.window->width, state.window->height, nullptr, false);
-    screen.UnBind();
+    // Texture 與 Renderbuffer 只有在放不下視窗或是大太多的時候才重新配置
+    RenderTargetPool& pool = RenderTargetPool::Shared();
+    bool reallocated = false;
+    for (RenderTarget& target : main_targets) {
+        reallocated = pool.Fit(target, state.window->width, state.window->height) || reallocated;
+    }
+    if (reallocated) {
+        main_renderbuffer->Resize(main_targets[0].allocated_width, main_targets[0].allocated_height);
+    }
 
-    Texture2D bloom = TextureManager::GetTexture2D("Bloom");
-    bloom.Bind();
-    bloom.Generate(GL_RGB16F, GL_RGB, state.window->width, state.window->height, nullptr, false);
-    bloom.UnBind();
+    for (RenderTarget& target : reduced_targets) {
+        pool.Fit(target, main_targets[0].allocated_width / 2, main_targets[0].allocated_height / 2);
+    }
+    UpdateRenderSize();
+    settled_width = render_width;
+    settled_height = render_height;
+    state.world->quality.Invalidate();
+}
 
-    for (int i = 0; i < 2; i++) {
-        Texture2D gaussian = TextureManager::GetTexture2D("GaussianBlur" + std::to_string(i));
-        gaussian.Bind();
-        gaussian.Generate(GL_RGB16F, GL_RGB, state.window->width, state.window->height, nullptr, false);
-        gaussian.UnBind();
+void Game::UpdateRenderSize() {
+    // A window larger than the storage is drawn at the largest size of the same aspect which fits, the screen pass stretches it.
+    const RenderTarget& target = main_targets[0];
+    const float scale = std::min({ 1.0f, static_cast<float>(target.allocated_width) / static_cast<float>(std::max(state.window->width, 1)),
+                                   static_cast<float>(target.allocated_height) / static_cast<float>(std::max(state.window->height, 1)) });
+    render_width = std::clamp(static_cast<int>(static_cast<float>(state.window->width) * scale), 1, target.allocated_width);
+    render_height = std::clamp(static_cast<int>(static_cast<float>(state.window->height) * scale), 1, target.allocated_height);
+    for (RenderTarget& main_target : main_targets) {
+        main_target.width = render_width;
+        main_target.height = render_height;
     }
 }
\ No newline at end of file
@@ -0,0 +1,104 @@
+#include "Maths/GradientBenchmark.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#include "Maths/Gradient.hpp"
+#include "Maths/GradientKernel.hpp"
+#include "Model/Volume.hpp"
+#include "Utility/Logger.hpp"
+
+namespace Maths {
+    namespace {
+        // The best of `repeat` runs, in seconds.
+        template<typename Function>
+        double BestOf(int repeat, Function&& function) {
+            double best = std::numeric_limits<double>::max();
+            for (int r = 0; r < repeat; r++) {
+                auto start = std::chrono::steady_clock::now();
+                function();
+                std::chrono::duration<double> cost = std::chrono::steady_clock::now() - start;
+                best = std::min(best, cost.count());
+            }
+            return best;
+        }
+
+        template<typename T>
+        int RunWith(const Volume& volume, int repeat) {
+            const ivec3& res = volume.m_info.resolution;
+            const std::size_t slice_size = static_cast<std::size_t>(res.x) * res.y;
+            const std::size_t voxel_count = volume.GetVoxelCount();
+            const double voxels_per_second = static_cast<double>(voxel_count);
+
+            // Single threaded on purpose, this compares the kernels and not the thread pool.
+            std::vector<glm::vec3> reference(voxel_count);
+            const double reference_cost = BestOf(repeat, [&]() {
+                for (int k = 0; k < res.z; k++) {
+                    for (int j = 0; j < res.y; j++) {
+                        for (int i = 0; i < res.x; i++) {
+                            reference[volume.GetIndex(i, j, k)] = Gradient::Compute<T>(i, j, k, volume);
+                        }
+                    }
+                }
+            });
+            Logger::Message(LogLevel::Info, "Per-voxel Compute: " + std::to_string(reference_cost * 1000.0) + " ms, "
+                                            + std::to_string(voxels_per_second / reference_cost / 1.0e6) + " Mvoxels/s");
+
+            const SimdLevel detected = GradientKernel::Detect();
+            int failures = 0;
+            std::vector<glm::vec3> normals(voxel_count);
+            std::vector<float> scratch;
+            for (unsigned int level = 0; level <= static_cast<unsigned int>(detected); level++) {
+                GradientKernel::SetLevel(static_cast<SimdLevel>(level));
+                const std::string name = GradientKernel::ShowLevel(GradientKernel::Level());
+
+                std::fill(normals.begin(), normals.end(), glm::vec3(std::numeric_limits<float>::quiet_NaN()));
+                const double cost = BestOf(repeat, [&]() {
+                    for (int k = 0; k < res.z; k++) {
+                        Gradient::ComputeSlice<T>(k, volume, normals.data() + k * slice_size, scratch);
+                    }
+                });
+
+                // Compare the bits, not the values: NaN from an unwritten voxel must fail too.
+                std::size_t mismatches = 0;
+                for (std::size_t n = 0; n < voxel_count; n++) {
+                    if (std::memcmp(&normals[n], &reference[n], sizeof(glm::vec3)) != 0) {
+                        mismatches++;
+                    }
+                }
+
+                const LogLevel log_level = mismatches == 0 ? LogLevel::Info : LogLevel::Error;
+                Logger::Message(log_level, name + " kernel: " + std::to_string(cost * 1000.0) + " ms, "
+                                           + std::to_string(voxels_per_second / cost / 1.0e6) + " Mvoxels/s, "
+                                           + "speedup x" + std::to_string(reference_cost / cost) + ", "
+                                           + std::to_string(mismatches) + " mismatched voxels");
+                if (mismatches != 0) {
+                    failures++;
+                }
+            }
+            GradientKernel::SetLevel(detected);
+
+            return failures == 0 ? 0 : 1;
+        }
+    }
+
+    int GradientBenchmark::Run(const std::string& info_file, int repeat) {
+        Logger::Message(LogLevel::Info, "Gradient benchmark on " + info_file);
+        const Volume volume(info_file, "", RawLoadMethod::MemoryMapped);
+        if (!volume.IsLoaded()) {
+            return 1;
+        }
+
+        const ivec3& res = volume.m_info.resolution;
+        Logger::Message(LogLevel::Info, "Resolution: (" + std::to_string(res.x) + ", " + std::to_string(res.y) + ", " + std::to_string(res.z) + "), "
+                                        + "Sample Type: " + volume.ShowSampleType() + ", "
+                                        + "Detected: " + GradientKernel::ShowLevel(GradientKernel::Detect()));
+
+        return DispatchSampleType(volume.m_info.sample_type, [&](auto tag) {
+            return RunWith<typename decltype(tag)::type>(volume, repeat);
+        });
+    }
+}
@@ -0,0 +1,147 @@
+#include "Maths/GradientKernel.hpp"
+
+#include <atomic>
+
+// 32-bit x86 does not guarantee SSE2, so only x86-64 gets the vector kernels
+#if defined(__x86_64__) || defined(_M_X64)
+    #define GRADIENT_KERNEL_X86
+    #include <immintrin.h>
+    #ifdef _MSC_VER
+        #include <intrin.h>
+    #endif
+#endif
+
+// GCC 與 Clang 需要標記函數才能使用 AVX2 指令，MSVC 則不需要
+#if defined(GRADIENT_KERNEL_X86) && (defined(__GNUC__) || defined(__clang__))
+    #define GRADIENT_KERNEL_AVX2 __attribute__((target("avx2")))
+#else
+    #define GRADIENT_KERNEL_AVX2
+#endif
+
+namespace Maths {
+    namespace {
+        void CentralDifferenceScalar(const GradientKernel::Row& row, int count, float denom_x, float denom_y, float denom_z,
+                                     float* gx, float* gy, float* gz) {
+            for (int n = 0; n < count; n++) {
+                gx[n] = (row.center[n + 2] - row.center[n]) / denom_x;
+                gy[n] = (row.y_next[n + 1] - row.y_prev[n + 1]) / denom_y;
+                gz[n] = (row.z_next[n + 1] - row.z_prev[n + 1]) / denom_z;
+            }
+        }
+
+#ifdef GRADIENT_KERNEL_X86
+        void CentralDifferenceSSE(const GradientKernel::Row& row, int count, float denom_x, float denom_y, float denom_z,
+                                  float* gx, float* gy, float* gz) {
+            const __m128 dx = _mm_set1_ps(denom_x);
+            const __m128 dy = _mm_set1_ps(denom_y);
+            const __m128 dz = _mm_set1_ps(denom_z);
+
+            int n = 0;
+            for (; n + 4 <= count; n += 4) {
+                const __m128 x = _mm_sub_ps(_mm_loadu_ps(row.center + n + 2), _mm_loadu_ps(row.center + n));
+                const __m128 y = _mm_sub_ps(_mm_loadu_ps(row.y_next + n + 1), _mm_loadu_ps(row.y_prev + n + 1));
+                const __m128 z = _mm_sub_ps(_mm_loadu_ps(row.z_next + n + 1), _mm_loadu_ps(row.z_prev + n + 1));
+                _mm_storeu_ps(gx + n, _mm_div_ps(x, dx));
+                _mm_storeu_ps(gy + n, _mm_div_ps(y, dy));
+                _mm_storeu_ps(gz + n, _mm_div_ps(z, dz));
+            }
+
+            // Tail of the row
+            const GradientKernel::Row tail = {row.center + n, row.y_prev + n, row.y_next + n, row.z_prev + n, row.z_next + n};
+            CentralDifferenceScalar(tail, count - n, denom_x, denom_y, denom_z, gx + n, gy + n, gz + n);
+        }
+
+        GRADIENT_KERNEL_AVX2
+        void CentralDifferenceAVX2(const GradientKernel::Row& row, int count, float denom_x, float denom_y, float denom_z,
+                                   float* gx, float* gy, float* gz) {
+            const __m256 dx = _mm256_set1_ps(denom_x);
+            const __m256 dy = _mm256_set1_ps(denom_y);
+            const __m256 dz = _mm256_set1_ps(denom_z);
+
+            int n = 0;
+            for (; n + 8 <= count; n += 8) {
+                const __m256 x = _mm256_sub_ps(_mm256_loadu_ps(row.center + n + 2), _mm256_loadu_ps(row.center + n));
+                const __m256 y = _mm256_sub_ps(_mm256_loadu_ps(row.y_next + n + 1), _mm256_loadu_ps(row.y_prev + n + 1));
+                const __m256 z = _mm256_sub_ps(_mm256_loadu_ps(row.z_next + n + 1), _mm256_loadu_ps(row.z_prev + n + 1));
+                _mm256_storeu_ps(gx + n, _mm256_div_ps(x, dx));
+                _mm256_storeu_ps(gy + n, _mm256_div_ps(y, dy));
+                _mm256_storeu_ps(gz + n, _mm256_div_ps(z, dz));
+            }
+
+            const GradientKernel::Row tail = {row.center + n, row.y_prev + n, row.y_next + n, row.z_prev + n, row.z_next + n};
+            CentralDifferenceSSE(tail, count - n, denom_x, denom_y, denom_z, gx + n, gy + n, gz + n);
+        }
+
+        bool SupportsAVX2() {
+#if defined(__GNUC__) || defined(__clang__)
+            return __builtin_cpu_supports("avx2");
+#elif defined(_MSC_VER)
+            int info[4];
+            __cpuid(info, 0);
+            if (info[0] < 7) {
+                return false;
+            }
+            __cpuid(info, 1);
+            const bool os_saves_ymm = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && ((_xgetbv(0) & 0x6) == 0x6);
+            __cpuidex(info, 7, 0);
+            return os_saves_ymm && (info[1] & (1 << 5));
+#else
+            return false;
+#endif
+        }
+#endif
+
+        std::atomic<SimdLevel>& CurrentLevel() {
+            static std::atomic<SimdLevel> level { GradientKernel::Detect() };
+            return level;
+        }
+    }
+
+    void GradientKernel::CentralDifference(const Row& row, int count, float denom_x, float denom_y, float denom_z,
+                                           float* gx, float* gy, float* gz) {
+        switch (Level()) {
+#ifdef GRADIENT_KERNEL_X86
+            case SimdLevel::AVX2:
+                CentralDifferenceAVX2(row, count, denom_x, denom_y, denom_z, gx, gy, gz);
+                break;
+            case SimdLevel::SSE:
+                CentralDifferenceSSE(row, count, denom_x, denom_y, denom_z, gx, gy, gz);
+                break;
+#endif
+            default:
+                CentralDifferenceScalar(row, count, denom_x, denom_y, denom_z, gx, gy, gz);
+                break;
+        }
+    }
+
+    SimdLevel GradientKernel::Detect() {
+#ifdef GRADIENT_KERNEL_X86
+        // SSE2 is part of every x86-64 CPU.
+        return SupportsAVX2() ? SimdLevel::AVX2 : SimdLevel::SSE;
+#else
+        return SimdLevel::Scalar;
+#endif
+    }
+
+    SimdLevel GradientKernel::Level() {
+        return CurrentLevel().load(std::memory_order_relaxed);
+    }
+
+    void GradientKernel::SetLevel(SimdLevel level) {
+        const SimdLevel detected = Detect();
+        CurrentLevel() = static_cast<unsigned int>(level) <= static_cast<unsigned int>(detected) ? level : detected;
+    }
+
+    std::string GradientKernel::ShowLevel(SimdLevel level) {
+        switch (level) {
+            case SimdLevel::Scalar:
+                return "Scalar";
+            case SimdLevel::SSE:
+                return "SSE";
+            case SimdLevel::AVX2:
+                return "AVX2";
+            default:
+                return "";
+        }
+    }
+}
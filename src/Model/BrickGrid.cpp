@@ -0,0 +1,41 @@
+#include "Model/BrickGrid.hpp"
+
+#include <cmath>
+
+void BrickGrid::UpdateOccupancy(const std::vector<float>& colormap) {
+    const int texel_count = static_cast<int>(colormap.size() / 4);
+    if (texel_count == 0) {
+        return;
+    }
+
+    // visible[n] = how many of the texels [0, n) have a non-zero alpha, so any range is answered in O(1).
+    std::vector<int>& visible = m_visible_texels;
+    visible.resize(texel_count + 1);
+    visible[0] = 0;
+    for (int i = 0; i < texel_count; i++) {
+        visible[i + 1] = visible[i] + (colormap[i * 4 + 3] > 0.0f ? 1 : 0);
+    }
+
+    const auto texel_of = [texel_count](float value) {
+        // Linear filtering of the transfer function reads texel floor(v * N - 0.5) and the next one.
+        const int texel = static_cast<int>(std::floor(value * static_cast<float>(texel_count) - 0.5f));
+        return std::clamp(texel, 0, texel_count - 1);
+    };
+
+    m_occupied_count = 0;
+    for (std::size_t n = 0; n < m_ranges.size(); n++) {
+        const int first = texel_of(m_ranges[n].x);
+        const int last = std::min(texel_of(m_ranges[n].y) + 1, texel_count - 1);
+        const bool is_visible = visible[last + 1] - visible[first] > 0;
+        m_occupancy[n] = is_visible ? 255 : 0;
+        m_occupied_count += is_visible ? 1 : 0;
+    }
+}
+
+std::size_t BrickGrid::GetBrickCount() const {
+    return static_cast<std::size_t>(m_brick_count.x) * m_brick_count.y * m_brick_count.z;
+}
+
+std::size_t BrickGrid::GetOccupiedCount() const {
+    return m_occupied_count;
+}
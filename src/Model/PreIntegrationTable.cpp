@@ -0,0 +1,65 @@
+#include "Model/PreIntegrationTable.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Utility/ThreadPool.hpp"
+
+void PreIntegrationTable::Build(const std::vector<float>& colormap) {
+    auto start = std::chrono::steady_clock::now();
+
+    const int size = static_cast<int>(colormap.size() / 4);
+    m_size = size;
+    m_texels.resize(static_cast<std::size_t>(size) * size * 4);
+    if (size == 0) {
+        return;
+    }
+
+    // The alpha of the transfer function is the opacity of one sample, as extinction it can be integrated:
+    // alpha = 1 - exp(-tau). An opaque texel is clamped so the extinction stays finite.
+    const auto extinction = [&colormap](int texel) {
+        const double alpha = std::clamp(static_cast<double>(colormap[texel * 4 + 3]), 0.0, 0.9999);
+        return -std::log(1.0 - alpha);
+    };
+
+    // Trapezoidal prefix sums between the texel centers, the TF texture is linearly filtered between them.
+    m_extinction_sum.assign(static_cast<std::size_t>(size), 0.0);
+    m_color_sum.assign(static_cast<std::size_t>(size) * 3, 0.0);
+    for (int n = 1; n < size; n++) {
+        const double tau_prev = extinction(n - 1);
+        const double tau = extinction(n);
+        m_extinction_sum[n] = m_extinction_sum[n - 1] + (tau_prev + tau) * 0.5;
+        for (int c = 0; c < 3; c++) {
+            const double color_prev = tau_prev * colormap[(n - 1) * 4 + c];
+            const double color = tau * colormap[n * 4 + c];
+            m_color_sum[n * 3 + c] = m_color_sum[(n - 1) * 3 + c] + (color_prev + color) * 0.5;
+        }
+    }
+
+    // Every entry is two lookups into the prefix sums, each task fills whole rows.
+    ThreadPool::Shared().ParallelFor(0, size, 16, [&](int row_begin, int row_end) {
+        for (int back = row_begin; back < row_end; back++) {
+            for (int front = 0; front < size; front++) {
+                float* texel = m_texels.data() + (static_cast<std::size_t>(back) * size + front) * 4;
+                if (front == back) {
+                    // A segment within one value is the point classification.
+                    std::copy_n(colormap.data() + front * 4, 4, texel);
+                    continue;
+                }
+
+                const int low = std::min(front, back);
+                const int high = std::max(front, back);
+                const double tau = m_extinction_sum[high] - m_extinction_sum[low];
+                // Average extinction over the values the segment passes through.
+                texel[3] = static_cast<float>(1.0 - std::exp(-tau / static_cast<double>(high - low)));
+                for (int c = 0; c < 3; c++) {
+                    const double color = m_color_sum[high * 3 + c] - m_color_sum[low * 3 + c];
+                    texel[c] = tau > 1e-12 ? static_cast<float>(color / tau)
+                                           : (colormap[low * 4 + c] + colormap[high * 4 + c]) * 0.5f;
+                }
+            }
+        }
+    });
+
+    m_build_cost = std::chrono::steady_clock::now() - start;
+}
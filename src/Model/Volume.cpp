@@ -3,15 +3,30 @@
 #include <toml++/toml.h>
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <chrono>
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <system_error>
 #include <thread>
+#include <type_traits>
 
 #include "Maths/Gradient.hpp"
+#include "Maths/Octahedral.hpp"
 #include "Utility/Logger.hpp"
+#include "Utility/MemoryMappedFile.hpp"
+#include "Utility/MemoryUsage.hpp"
+#include "Utility/ThreadPool.hpp"
 
-Volume::Volume(const std::string& info_file, const std::string& raw_file) :
-    m_vao(0), m_vbo(0), m_ebo(0) {
+// Samples converted per task when loading through the memory mapping.
+static constexpr std::size_t ConversionBlockSize = 1 << 18;
+
+Volume::Volume(const std::string& info_file, const std::string& raw_file, RawLoadMethod load_method, LoadingProgress* progress,
+               VolumeTextureLayout layout) :
+    m_min_value(0.0f), m_max_value(0.0f), m_layout(layout), m_vao(0), m_vbo(0), m_ebo(0), m_load_method(load_method),
+    m_peak_memory(0), m_peak_memory_after_preprocess(0), m_progress(progress) {
     m_info.info_file_path = info_file;
     if (!raw_file.empty()) {
         m_info.raw_file_path = raw_file;
@@ -24,32 +39,134 @@ Volume::~Volume() {
 }
 
 void Volume::Initialize() {
-
+    // 這裡只做 CPU 的工作，可能跑在背景執行緒，所以不可以呼叫任何 OpenGL 函數
     auto start = std::chrono::steady_clock::now();
 
-    LoadInfo();
-    LoadRaw();
-    ComputeNormals();
+    ReportProgress(LoadingStage::Parsing);
+    if (!LoadInfo() || IsCancelled()) {
+        return;
+    }
+
+    ReportProgress(LoadingStage::Reading);
+    auto raw_start = std::chrono::steady_clock::now();
+    if (!LoadRaw()) {
+        return;
+    }
+    m_raw_loading_cost = std::chrono::steady_clock::now() - raw_start;
+    m_peak_memory = MemoryUsage::PeakResidentBytes();
+    if (IsCancelled()) {
+        return;
+    }
+
+    ReportProgress(LoadingStage::Preprocessing);
+    auto preprocess_start = std::chrono::steady_clock::now();
+    Preprocess();
+    m_preprocess_cost = std::chrono::steady_clock::now() - preprocess_start;
+    m_peak_memory_after_preprocess = MemoryUsage::PeakResidentBytes();
+    if (IsCancelled()) {
+        return;
+    }
+
+    auto brick_start = std::chrono::steady_clock::now();
+    BuildBricks();
+    m_brick_cost = std::chrono::steady_clock::now() - brick_start;
 
     GenerateVertices();
-    BufferInitialize();
 
     auto end = std::chrono::steady_clock::now();
     m_loading_cost = end - start;
 
+    // The progress belongs to the loader, do not keep it after loading.
+    m_progress = nullptr;
+}
+
+bool Volume::IsLoaded() const {
+    return m_load_error.empty();
+}
+
+const std::string& Volume::LoadError() const {
+    return m_load_error;
+}
+
+bool Volume::Fail(const std::string& reason) {
+    Logger::Message(LogLevel::Error, reason);
+    m_load_error = reason;
+    Clear();
+    return false;
+}
+
+void Volume::Upload() {
+    auto start = std::chrono::steady_clock::now();
+
+    // Creating the 3D textures.
+    const Maths::ivec3& res = m_info.resolution;
+    m_texture = std::make_unique<Texture3D>();
+    switch (m_layout) {
+        case VolumeTextureLayout::PackedFloat:
+            m_texture->Generate(GL_RGBA32F, GL_RGBA, GL_FLOAT, res.x, res.y, res.z, m_texture_data.data());
+            break;
+        case VolumeTextureLayout::ScalarSnormRGB8:
+            UploadScalarTexture();
+            m_normal_texture = std::make_unique<Texture3D>();
+            m_normal_texture->Generate(GL_RGB8_SNORM, GL_RGB, GL_BYTE, res.x, res.y, res.z, m_normal_snorm.data());
+            break;
+        case VolumeTextureLayout::ScalarOctahedral:
+            UploadScalarTexture();
+            m_normal_texture = std::make_unique<Texture3D>();
+            m_normal_texture->Generate(GL_RG16, GL_RG, GL_UNSIGNED_SHORT, res.x, res.y, res.z, m_normal_octahedral.data());
+            break;
+    }
+    m_transfer_texture = std::make_unique<Texture1D>();
+
+    // The importance only depends on the voxels, unlike the occupancy it is uploaded once.
+    const Maths::ivec3& bricks = m_bricks.m_brick_count;
+    m_importance_texture = std::make_unique<Texture3D>();
+    m_importance_texture->Generate(GL_R8, GL_RED, GL_UNSIGNED_BYTE, bricks.x, bricks.y, bricks.z, m_bricks.m_importance.data());
+    m_importance_texture->SetFilterParameters(GL_NEAREST, GL_NEAREST);
+
+    // The texels live on the GPU from now on.
+    std::vector<glm::vec4>().swap(m_texture_data);
+    std::vector<int8_t>().swap(m_normal_snorm);
+    std::vector<uint16_t>().swap(m_normal_octahedral);
+
+    BufferInitialize();
+
+    m_upload_cost = std::chrono::steady_clock::now() - start;
+
     ShowMe();
-//    std::vector<int> counts(256, 0);
-//    for (int i = 0; i < m_data.size(); i++) {
-//        counts[m_data[i]]++;
-//    }
-//
-//    for (int i = 0; i < 256; i++) {
-//        std::cout << "m_data(value, counts): (" << i << ", " << counts[i] << ")\n";
-//    }
-//    auto max = std::max_element(m_distance.cbegin(), m_distance.cend());
-//    auto min = std::min_element(m_distance.cbegin(), m_distance.cend());
-//    std::cout << "Max: " << *max << std::endl;
-//    std::cout << "Min: " << *min << std::endl;
+}
+
+void Volume::UploadScalarTexture() {
+    // The voxels are uploaded as they are, the normalized formats are scaled back with GetValueScale() in the shader.
+    const Maths::ivec3& res = m_info.resolution;
+    DispatchSampleType(m_info.sample_type, [&](auto tag) {
+        using T = typename decltype(tag)::type;
+        const T* voxels = GetVoxels<T>().data();
+        if constexpr (std::is_same_v<T, uint8_t>) {
+            m_texture->Generate(GL_R8, GL_RED, GL_UNSIGNED_BYTE, res.x, res.y, res.z, voxels);
+        } else if constexpr (std::is_same_v<T, uint16_t>) {
+            m_texture->Generate(GL_R16, GL_RED, GL_UNSIGNED_SHORT, res.x, res.y, res.z, voxels);
+        } else if constexpr (std::is_same_v<T, int16_t>) {
+            m_texture->Generate(GL_R16_SNORM, GL_RED, GL_SHORT, res.x, res.y, res.z, voxels);
+        } else {
+            m_texture->Generate(GL_R32F, GL_RED, GL_FLOAT, res.x, res.y, res.z, voxels);
+        }
+    });
+}
+
+bool Volume::IsUploaded() const {
+    return m_vao != 0;
+}
+
+bool Volume::IsCancelled() const {
+    return m_progress != nullptr && m_progress->IsCancelled();
+}
+
+void Volume::ReportProgress(LoadingStage stage, float fraction) const {
+    if (m_progress != nullptr) {
+        m_progress->stage = stage;
+        m_progress->fraction = fraction;
+    }
 }
 
 void Volume::Bind() const {
@@ -71,30 +188,122 @@ void Volume::Draw() const {
 }
 
 void Volume::Destroy() {
-    glDeleteVertexArrays(1, &m_vao);
-    glDeleteBuffers(1, &m_vbo);
-    glDeleteBuffers(1, &m_ebo);
+    // A volume which is never uploaded (e.g. a cancelled one) owns no GL objects,
+    // and it may be destroyed on the loader thread.
+    if (IsUploaded()) {
+        glDeleteVertexArrays(1, &m_vao);
+        glDeleteBuffers(1, &m_vbo);
+        glDeleteBuffers(1, &m_ebo);
+        m_vao = m_vbo = m_ebo = 0;
+    }
+    if (m_texture) {
+        m_texture->Destroy();
+        m_texture = nullptr;
+    }
+    if (m_normal_texture) {
+        m_normal_texture->Destroy();
+        m_normal_texture = nullptr;
+    }
+    if (m_occupancy_texture) {
+        m_occupancy_texture->Destroy();
+        m_occupancy_texture = nullptr;
+    }
+    if (m_importance_texture) {
+        m_importance_texture->Destroy();
+        m_importance_texture = nullptr;
+    }
+    if (m_preintegration_texture) {
+        m_preintegration_texture->Destroy();
+        m_preintegration_texture = nullptr;
+    }
+    if (m_transfer_texture) {
+        m_transfer_texture->Destroy();
+        m_transfer_texture = nullptr;
+    }
     Clear();
 }
 
 void Volume::GenerateTFTexture(const TransferFunctionWidget& tf_widget) {
     const std::vector<float>& colormap = tf_widget.GetColorData();
-    const size_t texel_count = colormap.size() / sizeof(float);
+    const int texel_count = static_cast<int>(colormap.size() / 4);
+    const TransferFunctionWidget::TexelRange& changed = tf_widget.GetChangedRange();
+
+    // The storage is made once per volume (and when the domain changes), edits only upload the texels they touched.
+    const bool is_allocated = m_transfer_texture->m_width == texel_count;
+    if (!is_allocated) {
+        m_transfer_texture->Generate(GL_RGBA, GL_RGBA, texel_count, colormap.data());
+    } else if (!changed.Empty()) {
+        m_transfer_texture->Update(GL_RGBA, changed.begin, changed.end - changed.begin, colormap.data() + changed.begin * 4);
+    }
 
-    // Make it into 1D texture
-    m_transfer_texture.Bind();
-    m_transfer_texture.Generate(GL_RGBA, GL_RGBA, texel_count, colormap.data());
-    m_transfer_texture.UnBind();
+    // Any texel changes the integrals of every segment across it, so the whole table is rebuilt.
+    if (!is_allocated || !changed.Empty()) {
+        m_preintegration.Build(colormap);
+        const int table_size = m_preintegration.m_size;
+        if (!m_preintegration_texture || !is_allocated) {
+            if (!m_preintegration_texture) {
+                m_preintegration_texture = std::make_unique<Texture2D>();
+            }
+            m_preintegration_texture->Generate(GL_RGBA32F, GL_RGBA, table_size, table_size, m_preintegration.m_texels.data());
+        } else {
+            m_preintegration_texture->Update(GL_RGBA, table_size, table_size, m_preintegration.m_texels.data());
+        }
+    }
+
+    // Which bricks are visible depends on the opacity only, a change of colors keeps the occupancy.
+    const bool alpha_changed = (changed.channels & (1u << static_cast<unsigned int>(Channel::Alpha))) != 0;
+    if (is_allocated && m_occupancy_texture && !alpha_changed) {
+        return;
+    }
+    m_bricks.UpdateOccupancy(colormap);
+    const Maths::ivec3& bricks = m_bricks.m_brick_count;
+    if (!m_occupancy_texture) {
+        m_occupancy_texture = std::make_unique<Texture3D>();
+        m_occupancy_texture->Generate(GL_R8, GL_RED, GL_UNSIGNED_BYTE, bricks.x, bricks.y, bricks.z, m_bricks.m_occupancy.data());
+        m_occupancy_texture->SetFilterParameters(GL_NEAREST, GL_NEAREST);
+    } else {
+        m_occupancy_texture->Update(GL_RED, GL_UNSIGNED_BYTE, bricks.x, bricks.y, bricks.z, m_bricks.m_occupancy.data());
+    }
 }
 
 int Volume::GetIndex(const int &i, const int &j, const int &k) const {
     return k * (m_info.resolution.y * m_info.resolution.x) + (j * m_info.resolution.x) + i;
 }
 
-float Volume::GetVoxelVal(const int &i, const int &j, const int &k) const {
-    int index = GetIndex(i, j, k);
-    assert(index >= 0 && index < m_data.size());
-    return m_data[GetIndex(i, j, k)];
+float Volume::GetValueScale() const {
+    if (m_layout == VolumeTextureLayout::PackedFloat) {
+        return 1.0f;
+    }
+
+    // Normalized formats are sampled as value / type max (UNORM / SNORM), R32F is sampled as it is.
+    const float type_max = DispatchSampleType(m_info.sample_type, [](auto tag) {
+        using T = typename decltype(tag)::type;
+        return std::is_integral_v<T> ? static_cast<float>(std::numeric_limits<T>::max()) : 1.0f;
+    });
+    return type_max / m_max_value;
+}
+
+std::size_t Volume::GetTextureBytes(VolumeTextureLayout layout) const {
+    const std::size_t voxel_count = GetVoxelCount();
+    switch (layout) {
+        case VolumeTextureLayout::PackedFloat:
+            return voxel_count * sizeof(glm::vec4);
+        case VolumeTextureLayout::ScalarSnormRGB8:
+            // The upload is tightly packed, but drivers store 3-byte texels padded to 4 bytes
+            return GetVoxelBytes() + voxel_count * 4 * sizeof(int8_t);
+        case VolumeTextureLayout::ScalarOctahedral:
+            return GetVoxelBytes() + voxel_count * 2 * sizeof(uint16_t);
+        default:
+            return 0;
+    }
+}
+
+std::size_t Volume::GetVoxelCount() const {
+    return std::visit([](const auto& voxels) { return voxels.size(); }, m_data);
+}
+
+std::size_t Volume::GetVoxelBytes() const {
+    return std::visit([](const auto& voxels) { return voxels.size() * sizeof(voxels[0]); }, m_data);
 }
 
 void Volume::ShowMe() {
@@ -108,8 +317,22 @@ void Volume::ShowMe() {
     Logger::Message(LogLevel::Debug, "Voxel Size: (" + std::to_string(size.x) + ", " + std::to_string(size.y) + ", " + std::to_string(size.z) + ")");
     Logger::Message(LogLevel::Debug, "Sample Type: " + ShowSampleType());
     Logger::Message(LogLevel::Debug, "Endianness: " + ShowEndianness());
-    Logger::Message(LogLevel::Debug, "Size of Raw Data: " + std::to_string(m_data.size()));
+    Logger::Message(LogLevel::Debug, "Size of Raw Data: " + std::to_string(GetVoxelCount()));
+    Logger::Message(LogLevel::Debug, "Voxel Memory: " + MemoryUsage::FormatBytes(GetVoxelBytes()));
+    Logger::Message(LogLevel::Debug, "Raw Loader: " + ShowLoadMethod());
+    Logger::Message(LogLevel::Debug, "Texture Layout: " + ShowLayout(m_layout) + ", " + MemoryUsage::FormatBytes(GetTextureBytes(m_layout)));
+    Logger::Message(LogLevel::Debug, "Texture Memory of Every Layout: "
+                                     + ShowLayout(VolumeTextureLayout::PackedFloat) + " " + MemoryUsage::FormatBytes(GetTextureBytes(VolumeTextureLayout::PackedFloat)) + ", "
+                                     + ShowLayout(VolumeTextureLayout::ScalarSnormRGB8) + " " + MemoryUsage::FormatBytes(GetTextureBytes(VolumeTextureLayout::ScalarSnormRGB8)) + ", "
+                                     + ShowLayout(VolumeTextureLayout::ScalarOctahedral) + " " + MemoryUsage::FormatBytes(GetTextureBytes(VolumeTextureLayout::ScalarOctahedral)));
+    Logger::Message(LogLevel::Debug, "Value Range: [" + std::to_string(m_min_value) + ", " + std::to_string(m_max_value) + "]");
+    Logger::Message(LogLevel::Debug, "Raw Loading Cost: " + std::to_string(m_raw_loading_cost.count()) + " seconds.");
+    Logger::Message(LogLevel::Debug, "Peak RSS after Loading Raw: " + MemoryUsage::FormatBytes(m_peak_memory));
+    Logger::Message(LogLevel::Debug, "Gradient & Packing Cost: " + std::to_string(m_preprocess_cost.count()) + " seconds with " + std::to_string(ThreadPool::Shared().Size()) + " threads (" + Maths::GradientKernel::ShowLevel(Maths::GradientKernel::Level()) + ").");
+    Logger::Message(LogLevel::Debug, "Brick Grid: (" + std::to_string(m_bricks.m_brick_count.x) + ", " + std::to_string(m_bricks.m_brick_count.y) + ", " + std::to_string(m_bricks.m_brick_count.z) + ") bricks of " + std::to_string(BrickGrid::BrickSize) + "^3, built in " + std::to_string(m_brick_cost.count()) + " seconds.");
+    Logger::Message(LogLevel::Debug, "Peak RSS after Preprocessing: " + MemoryUsage::FormatBytes(m_peak_memory_after_preprocess));
     Logger::Message(LogLevel::Debug, "Cost Time: " + std::to_string(m_loading_cost.count()) + " seconds.");
+    Logger::Message(LogLevel::Debug, "Upload Time: " + std::to_string(m_upload_cost.count()) + " seconds.");
     Logger::Spacing();
 }
 
@@ -139,41 +362,128 @@ std::string Volume::ShowEndianness() const {
     }
 }
 
-void Volume::ComputeNormals() {
-    for (int k = 0; k < m_info.resolution.z; k++) {
-        for (int j = 0; j < m_info.resolution.y; j++) {
-            for (int i = 0; i < m_info.resolution.x; i++) {
-                glm::vec3 norm = Maths::Gradient::Compute(i, j, k, *this);
-
-                // 不要 normalize，不然會出現方格塊狀
-                // norm = glm::normalize(norm);
-                m_normals.push_back(norm);
-            }
-        }
+std::string Volume::ShowLoadMethod() const {
+    switch (m_load_method) {
+        case RawLoadMethod::Stream:
+            return "Stream (ifstream)";
+        case RawLoadMethod::MemoryMapped:
+            return "Memory-Mapped";
+        default:
+            return "";
     }
 }
 
-void Volume::GenerateTextureData() {
-    const auto& temp_data = m_data;
+std::string Volume::ShowLayout(VolumeTextureLayout layout) {
+    switch (layout) {
+        case VolumeTextureLayout::PackedFloat:
+            return "RGBA32F";
+        case VolumeTextureLayout::ScalarSnormRGB8:
+            return "Scalar + RGB8_SNORM Normal";
+        case VolumeTextureLayout::ScalarOctahedral:
+            return "Scalar + RG16 Octahedral Normal";
+        default:
+            return "";
+    }
+}
 
-    // 1. Generate a new data (r, g, b, a) and sent into GPU rgb as normal and a as voxel value;
-    const float& max_value = *std::max_element(temp_data.cbegin(), temp_data.cend());
+void Volume::Preprocess() {
+    DispatchSampleType(m_info.sample_type, [this](auto tag) {
+        Preprocess<typename decltype(tag)::type>();
+    });
+}
 
-    for (int i = 0; i < temp_data.size(); i++) {
-        glm::vec3 norm = m_normals[i];
-        float val = temp_data[i] / max_value;
-        m_texture_data.emplace_back(norm, val);
+template<typename T>
+void Volume::Preprocess() {
+    const Maths::ivec3& res = m_info.resolution;
+    const std::size_t slice_size = static_cast<std::size_t>(res.x) * res.y;
+    const std::vector<T>& voxels = GetVoxels<T>();
+    const float max_value = m_max_value;
+
+    // 1. Generate a new data (r, g, b, a) and sent into GPU rgb as normal and a as voxel value,
+    //    or only the quantized normals for the compact layouts (the voxels themselves are uploaded as they are);
+    //    every slice writes its own part of the preallocated output, so slabs are independent of each other.
+    switch (m_layout) {
+        case VolumeTextureLayout::PackedFloat:
+            m_texture_data.resize(voxels.size());
+            break;
+        case VolumeTextureLayout::ScalarSnormRGB8:
+            m_normal_snorm.resize(voxels.size() * 3);
+            break;
+        case VolumeTextureLayout::ScalarOctahedral:
+            m_normal_octahedral.resize(voxels.size() * 2);
+            break;
     }
 
-    // 2. Creating a 3D texture.
-    m_texture.Generate(GL_RGBA32F, GL_RGBA,
-                       m_info.resolution.x, m_info.resolution.y, m_info.resolution.z,
-                       reinterpret_cast<const float *>(m_texture_data.data()));
+    ThreadPool& pool = ThreadPool::Shared();
+    const int slab_depth = std::max(1, res.z / static_cast<int>(pool.Size() * 4));
+    std::atomic<int> finished_slices = 0;
+
+    pool.ParallelFor(0, res.z, slab_depth, [&](int k_begin, int k_end) {
+        // The halo (slices k - 1 and k + 1) is read straight from m_data, only one slice of normals is kept.
+        std::vector<glm::vec3> normals(slice_size);
+        std::vector<float> scratch;
+
+        for (int k = k_begin; k < k_end; k++) {
+            if (IsCancelled()) {
+                return;
+            }
+
+            // 不要 normalize，不然會出現方格塊狀
+            Maths::Gradient::ComputeSlice<T>(k, *this, normals.data(), scratch);
+
+            if (m_layout == VolumeTextureLayout::PackedFloat) {
+                const T* values = voxels.data() + k * slice_size;
+                glm::vec4* texels = m_texture_data.data() + k * slice_size;
+                for (std::size_t n = 0; n < slice_size; n++) {
+                    texels[n] = glm::vec4(normals[n], static_cast<float>(values[n]) / max_value);
+                }
+            } else {
+                PackNormals(normals.data(), k * slice_size, slice_size);
+            }
+
+            const int done = ++finished_slices;
+            ReportProgress(LoadingStage::Preprocessing, static_cast<float>(done) / static_cast<float>(res.z));
+        }
+    });
+
+    // 2. The 3D texture is created from m_texture_data in Upload() on the GL thread.
 }
 
-void Volume::GenerateVertices() {
-    GenerateTextureData();
+void Volume::BuildBricks() {
+    DispatchSampleType(m_info.sample_type, [this](auto tag) {
+        using T = typename decltype(tag)::type;
+        m_bricks.Build<T>(GetVoxels<T>().data(), m_info.resolution, m_max_value);
+    });
+}
 
+void Volume::PackNormals(const glm::vec3* normals, std::size_t offset, std::size_t count) {
+    // Only the direction matters for shading, so the normals are stored as unit vectors (zero stays zero for RGB8).
+    if (m_layout == VolumeTextureLayout::ScalarSnormRGB8) {
+        int8_t* output = m_normal_snorm.data() + offset * 3;
+        for (std::size_t n = 0; n < count; n++) {
+            const glm::vec3 unit = Maths::Octahedral::Normalize(normals[n]);
+            output[n * 3 + 0] = Maths::Octahedral::ToSnorm8(unit.x);
+            output[n * 3 + 1] = Maths::Octahedral::ToSnorm8(unit.y);
+            output[n * 3 + 2] = Maths::Octahedral::ToSnorm8(unit.z);
+        }
+    } else {
+        uint16_t* output = m_normal_octahedral.data() + offset * 2;
+        for (std::size_t n = 0; n < count; n++) {
+            // Every encoded direction has a non-zero texel, (0, 0) is left for the gradients without one
+            const glm::vec3 unit = Maths::Octahedral::Normalize(normals[n]);
+            if (unit == glm::vec3(0.0f)) {
+                output[n * 2 + 0] = Maths::Octahedral::ZeroSentinel;
+                output[n * 2 + 1] = Maths::Octahedral::ZeroSentinel;
+                continue;
+            }
+            const glm::vec2 encoded = Maths::Octahedral::Encode(unit);
+            output[n * 2 + 0] = Maths::Octahedral::ToUnorm16(encoded.x);
+            output[n * 2 + 1] = Maths::Octahedral::ToUnorm16(encoded.y);
+        }
+    }
+}
+
+void Volume::GenerateVertices() {
     // Creating a cube with texture coordinate.
     float res_x = static_cast<float>(m_info.resolution.x) * m_info.voxel_size.x;
     float res_y = static_cast<float>(m_info.resolution.y) * m_info.voxel_size.y;
@@ -227,20 +537,21 @@ void Volume::BufferInitialize() {
 }
 
 void Volume::Clear() {
-    m_data.clear();
-    m_normals.clear();
+    std::visit([](auto& voxels) { voxels.clear(); }, m_data);
+    std::vector<glm::vec4>().swap(m_texture_data);
+    std::vector<int8_t>().swap(m_normal_snorm);
+    std::vector<uint16_t>().swap(m_normal_octahedral);
     m_vertices.clear();
     m_indices.clear();
 }
 
-void Volume::LoadInfo() {
+bool Volume::LoadInfo() {
     // 1. Load the Info file first (a TOML File)
     toml::table tbl;
     try {
         tbl = toml::parse_file(m_info.info_file_path);
     } catch (const toml::parse_error& err) {
-        Logger::Message(LogLevel::Error, "Failed to parsing info file (TOML) at file: " + m_info.info_file_path + "\n reason: \n" + std::string(err.description()) + "\n");
-        exit(-1);
+        return Fail("Failed to parsing info file (TOML) at file: " + m_info.info_file_path + "\n reason: \n" + std::string(err.description()) + "\n");
     }
 
     const auto& resolution_node = tbl["resolution"];
@@ -282,61 +593,136 @@ void Volume::LoadInfo() {
         m_info.sample_type = SampleType::Float;
     }
 
-    // Assertions in Debugs mode
-    assert(m_info.resolution.x > 0 && m_info.resolution.y > 0 && m_info.resolution.z > 0);
-    assert(m_info.voxel_size.x > 0.0f && m_info.voxel_size.y > 0.0f && m_info.voxel_size.z > 0.0f);
-    assert(!sample_type_string.empty());
+    // 檔案是使用者在 GUI 選的，格式錯誤時只回報，不結束程式
+    if (m_info.resolution.x <= 0 || m_info.resolution.y <= 0 || m_info.resolution.z <= 0) {
+        return Fail("Invalid resolution in the info file: " + m_info.info_file_path);
+    }
+    if (m_info.voxel_size.x <= 0.0f || m_info.voxel_size.y <= 0.0f || m_info.voxel_size.z <= 0.0f) {
+        return Fail("Invalid voxel size in the info file: " + m_info.info_file_path);
+    }
+    if (sample_type_string.empty()) {
+        return Fail("Unknown sample type in the info file: " + m_info.info_file_path);
+    }
+    return true;
 }
 
-void Volume::LoadRaw() {
-    // 1. Load the RAW file
-    std::ifstream file(m_info.raw_file_path, std::ios::binary);
-    if (file.fail()) {
-        Logger::Message(LogLevel::Error, "Failed to load the RAW file, file path: " + m_info.raw_file_path);
-        exit(-1);
+bool Volume::LoadRaw() {
+    bool loaded = false;
+    if (m_load_method == RawLoadMethod::MemoryMapped) {
+        loaded = LoadRawFromMapping();
+        if (!loaded) {
+            // 某些檔案系統（例如網路磁碟）無法 mmap，這時候退回一般的讀檔方式
+            Logger::Message(LogLevel::Warning, "Fall back to stream loading for the RAW file: " + m_info.raw_file_path);
+            m_load_method = RawLoadMethod::Stream;
+        }
+    }
+    if (!loaded && !LoadRawFromStream()) {
+        return false;
     }
-    size_t file_size = std::filesystem::file_size(m_info.raw_file_path);
 
-    switch (m_info.sample_type) {
-        case SampleType::UnsignedChar: {
-            std::vector<uint8_t> buffer(file_size / sizeof(uint8_t));
-            file.read(reinterpret_cast<char*>(buffer.data()), static_cast<std::streamsize>(file_size));
-            m_data.assign(buffer.begin(), buffer.end());
-            break;
-        }
-        case SampleType::UnsignedShort: {
-            std::vector<uint16_t> buffer(file_size / sizeof(uint16_t));
-            file.read(reinterpret_cast<char*>(buffer.data()), static_cast<std::streamsize>(file_size));
-            if (m_info.endian == Endianness::Big) {
-                for (auto& single : buffer) {
-                    single = ntoh(single);
-                }
-            }
-            m_data.assign(buffer.begin(), buffer.end());
-            break;
-        }
-        case SampleType::Short: {
-            std::vector<int16_t> buffer(file_size / sizeof(int16_t));
-            file.read(reinterpret_cast<char*>(buffer.data()), static_cast<std::streamsize>(file_size));
-            if (m_info.endian == Endianness::Big) {
-                for (auto& single : buffer) {
-                    single = ntoh(single);
+    // Everything after this indexes the voxels by the resolution
+    const Maths::ivec3& res = m_info.resolution;
+    if (GetVoxelCount() < static_cast<std::size_t>(res.x) * res.y * res.z) {
+        return Fail("The RAW file is smaller than the resolution of the info file: " + m_info.raw_file_path);
+    }
+    return true;
+}
+
+bool Volume::LoadRawFromMapping() {
+    MemoryMappedFile file(m_info.raw_file_path);
+    if (!file.IsOpen()) {
+        return false;
+    }
+
+    // Convert straight from the mapped pages into the typed voxel store, there is no intermediate buffer.
+    DispatchSampleType(m_info.sample_type, [&](auto tag) {
+        using T = typename decltype(tag)::type;
+        ConvertSamples<T>(file.Data(), file.Size() / sizeof(T));
+    });
+
+    return true;
+}
+
+template<typename T>
+void Volume::ConvertSamples(const unsigned char* source, std::size_t count) {
+    std::vector<T>& voxels = m_data.emplace<std::vector<T>>(count);
+    const bool swap_bytes = m_info.endian == Endianness::Big && sizeof(T) > 1;
+
+    // Block by block, so the value range is scanned while the converted block is still in cache.
+    const int block_count = static_cast<int>((count + ConversionBlockSize - 1) / ConversionBlockSize);
+    std::mutex range_mutex;
+    T min_value = std::numeric_limits<T>::max();
+    T max_value = std::numeric_limits<T>::lowest();
+
+    ThreadPool::Shared().ParallelFor(0, block_count, 1, [&](int block_begin, int block_end) {
+        for (int block = block_begin; block < block_end; block++) {
+            const std::size_t begin = static_cast<std::size_t>(block) * ConversionBlockSize;
+            const std::size_t size = std::min(ConversionBlockSize, count - begin);
+            T* target = voxels.data() + begin;
+
+            if (swap_bytes) {
+                // The mapped bytes have no alignment guarantee for T, so copy every sample out with memcpy
+                // (compilers turn it into a single unaligned load).
+                for (std::size_t i = 0; i < size; i++) {
+                    T value;
+                    std::memcpy(&value, source + (begin + i) * sizeof(T), sizeof(T));
+                    target[i] = ntoh(value);
                 }
+            } else {
+                // Same byte order as the host, the samples can be copied as a whole.
+                std::memcpy(target, source + begin * sizeof(T), size * sizeof(T));
             }
-            m_data.assign(buffer.begin(), buffer.end());
-            break;
+
+            const auto range = std::minmax_element(target, target + size);
+            std::lock_guard<std::mutex> lock(range_mutex);
+            min_value = std::min(min_value, *range.first);
+            max_value = std::max(max_value, *range.second);
         }
-        case SampleType::Float: {
-            std::vector<float> buffer(file_size / sizeof(float));
-            file.read(reinterpret_cast<char*>(buffer.data()), static_cast<std::streamsize>(file_size));
-            if (m_info.endian == Endianness::Big) {
-                for (auto& single : buffer) {
-                    single = ntoh(single);
-                }
-            }
-            m_data.assign(buffer.begin(), buffer.end());
-            break;
+    });
+
+    if (count > 0) {
+        SetValueRange(min_value, max_value);
+    }
+}
+
+template<typename T>
+void Volume::ReadSamples(std::ifstream& file, std::size_t file_size) {
+    std::vector<T>& voxels = m_data.emplace<std::vector<T>>(file_size / sizeof(T));
+    file.read(reinterpret_cast<char*>(voxels.data()), static_cast<std::streamsize>(voxels.size() * sizeof(T)));
+    if (m_info.endian == Endianness::Big && sizeof(T) > 1) {
+        for (auto& single : voxels) {
+            single = ntoh(single);
         }
     }
+
+    if (!voxels.empty()) {
+        const auto range = std::minmax_element(voxels.cbegin(), voxels.cend());
+        SetValueRange(*range.first, *range.second);
+    }
+}
+
+template<typename T>
+void Volume::SetValueRange(T min_value, T max_value) {
+    m_min_value = static_cast<float>(min_value);
+    m_max_value = static_cast<float>(max_value);
+}
+
+bool Volume::LoadRawFromStream() {
+    // 1. Load the RAW file
+    std::ifstream file(m_info.raw_file_path, std::ios::binary);
+    if (file.fail()) {
+        return Fail("Failed to load the RAW file, file path: " + m_info.raw_file_path);
+    }
+    std::error_code error;
+    const std::uintmax_t file_size = std::filesystem::file_size(m_info.raw_file_path, error);
+    if (error) {
+        return Fail("Failed to get the size of the RAW file: " + m_info.raw_file_path);
+    }
+
+    // Read straight into the typed voxel store.
+    DispatchSampleType(m_info.sample_type, [&](auto tag) {
+        ReadSamples<typename decltype(tag)::type>(file, static_cast<std::size_t>(file_size));
+    });
     file.close();
-}
\ No newline at end of file
+    return true;
+}
@@ -0,0 +1,96 @@
+#include "Model/VolumeLoader.hpp"
+
+#include <algorithm>
+
+#include "Utility/Logger.hpp"
+
+VolumeLoader::~VolumeLoader() {
+    Shutdown();
+}
+
+void VolumeLoader::Start(const std::string& info_file, VolumeTextureLayout layout) {
+    // Only one volume is loaded at a time, the newer request wins.
+    Cancel();
+
+    m_current_file = info_file;
+    m_last_error.clear();
+    m_job = std::make_unique<Job>();
+    m_job->info_file = info_file;
+    m_job->worker = std::thread(&VolumeLoader::Work, m_job.get(), layout);
+}
+
+void VolumeLoader::Cancel() {
+    // 不在 GUI 執行緒上等待：背景執行緒會在下一個檢查點停下來，之後再由 TakeResult() 回收
+    if (m_job) {
+        m_job->progress.cancel_requested = true;
+        m_cancelled.push_back(std::move(m_job));
+    }
+    Retire(false);
+}
+
+void VolumeLoader::Shutdown() {
+    Cancel();
+    Retire(true);
+}
+
+bool VolumeLoader::IsBusy() const {
+    return m_job != nullptr;
+}
+
+std::unique_ptr<Volume> VolumeLoader::TakeResult() {
+    if (!m_cancelled.empty()) {
+        Retire(false);
+    }
+    if (!m_job || !m_job->finished.load(std::memory_order_acquire)) {
+        return nullptr;
+    }
+
+    // The worker is past its last step, joining does not block
+    m_job->worker.join();
+    std::unique_ptr<Volume> result = std::move(m_job->result);
+    if (!result) {
+        m_last_error = m_job->error;
+    }
+    m_job = nullptr;
+    return result;
+}
+
+const LoadingProgress& VolumeLoader::Progress() const {
+    return m_job ? m_job->progress : m_idle_progress;
+}
+
+const std::string& VolumeLoader::CurrentFile() const {
+    return m_current_file;
+}
+
+const std::string& VolumeLoader::LastError() const {
+    return m_last_error;
+}
+
+void VolumeLoader::Retire(bool wait) {
+    const auto done = std::remove_if(m_cancelled.begin(), m_cancelled.end(), [wait](const std::unique_ptr<Job>& job) {
+        if (!wait && !job->finished.load(std::memory_order_acquire)) {
+            return false;
+        }
+        job->worker.join();
+        return true;
+    });
+    m_cancelled.erase(done, m_cancelled.end());
+}
+
+void VolumeLoader::Work(Job* job, VolumeTextureLayout layout) {
+    auto volume = std::make_unique<Volume>(job->info_file, "", RawLoadMethod::MemoryMapped, &job->progress, layout);
+
+    if (job->progress.IsCancelled()) {
+        job->progress.SetStage(LoadingStage::Cancelled);
+        Logger::Message(LogLevel::Info, "Loading of the volume was cancelled: " + job->info_file);
+    } else if (!volume->IsLoaded()) {
+        // The volume on screen stays, the GUI shows the reason
+        job->error = volume->LoadError();
+        job->progress.SetStage(LoadingStage::Failed);
+    } else {
+        job->progress.SetStage(LoadingStage::Uploading);
+        job->result = std::move(volume);
+    }
+    job->finished.store(true, std::memory_order_release);
+}
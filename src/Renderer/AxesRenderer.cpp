@@ -2,16 +2,14 @@
 
 AxesRenderer::AxesRenderer(BasicShader* shader) : m_shader(shader) {
     model = std::make_unique<MatrixStack>();
+    m_object_color = m_shader->RegisterUniform("objectColor");
+    m_model = m_shader->RegisterUniform("model");
 }
 
 void AxesRenderer::Prepare(const std::unique_ptr<Camera>& camera) {
+    // View, projection and the bloom threshold come from FrameData.
     m_shader->Start();
-    m_shader->SetVec3("objectColor", glm::vec3(0.0f));
-
-    // Load View and Projection Matrix
-    m_shader->SetViewAndProj(camera);
-    m_shader->SetVec3("viewPos", camera->position);
-    m_shader->SetFloat("bloomThreshold", state.world->bloom_threshold);
+    m_shader->SetVec3(m_object_color, glm::vec3(0.0f));
 }
 
 void AxesRenderer::Render(float length) {
@@ -47,24 +45,24 @@ void AxesRenderer::DrawAxes(float length) {
     model->Push();
     model->Save(glm::translate(model->Top(), glm::vec3(length / 2.0f, 0.0f, 0.0f)));
     model->Save(glm::scale(model->Top(), glm::vec3(length, length / 20.0f, length / 20.0f)));
-    m_shader->SetVec3("objectColor", glm::vec3(1.2f, 0.0f, 0.0f));
-    m_shader->SetMat4("model", model->Top());
+    m_shader->SetVec3(m_object_color, glm::vec3(1.2f, 0.0f, 0.0f));
+    m_shader->SetMat4(m_model, model->Top());
     state.world->my_cube->Draw();
     model->Pop();
 
     model->Push();
     model->Save(glm::translate(model->Top(), glm::vec3(0.0f, length / 2.0f, 0.0f)));
     model->Save(glm::scale(model->Top(), glm::vec3(length / 20.0f, length, length / 20.0f)));
-    m_shader->SetVec3("objectColor", glm::vec3(0.0f, 1.2f, 0.0f));
-    m_shader->SetMat4("model", model->Top());
+    m_shader->SetVec3(m_object_color, glm::vec3(0.0f, 1.2f, 0.0f));
+    m_shader->SetMat4(m_model, model->Top());
     state.world->my_cube->Draw();
     model->Pop();
 
     model->Push();
     model->Save(glm::translate(model->Top(), glm::vec3(0.0f, 0.0f, length / 2.0f)));
     model->Save(glm::scale(model->Top(), glm::vec3(length / 20.0f, length / 20.0f, length)));
-    m_shader->SetVec3("objectColor", glm::vec3(0.0f, 0.0f, 1.2f));
-    m_shader->SetMat4("model", model->Top());
+    m_shader->SetVec3(m_object_color, glm::vec3(0.0f, 0.0f, 1.2f));
+    m_shader->SetMat4(m_model, model->Top());
     state.world->my_cube->Draw();
     model->Pop();
 }
\ No newline at end of file
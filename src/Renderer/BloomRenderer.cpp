@@ -0,0 +1,50 @@
+#include "Renderer/BloomRenderer.hpp"
+
+#include <glad/glad.h>
+
+#include <algorithm>
+
+BloomRenderer::BloomRenderer(BloomShader* shader) : m_shader(shader) {
+    m_filter_radius = m_shader->RegisterUniform("filterRadius");
+    m_region = m_shader->RegisterUniform("region");
+}
+
+int BloomRenderer::ChainDepth(int levels, int width, int height) {
+    int depth = std::clamp(levels, 1, MaxLevels);
+    while (depth > 1 && (std::min(width, height) >> depth) < 2) {
+        depth--;
+    }
+    return depth;
+}
+
+int BloomRenderer::LevelWidth(int level, int width) {
+    return std::max(width >> (level + 1), 1);
+}
+
+int BloomRenderer::LevelHeight(int level, int height) {
+    return std::max(height >> (level + 1), 1);
+}
+
+void BloomRenderer::WarmUp() {
+    m_downsample = m_shader->GetVariant(m_downsample_defines);
+    m_upsample = m_shader->GetVariant(m_upsample_defines);
+}
+
+void BloomRenderer::Downsample(const Texture2D* source, const glm::vec2& region, const Screen* screen) {
+    m_shader->UseVariant(m_downsample);
+    m_shader->Start();
+    m_shader->SetVec2(m_region, region);
+
+    source->Bind(GL_TEXTURE0);
+    screen->Draw();
+}
+
+void BloomRenderer::Upsample(const Texture2D* source, const glm::vec2& region, const Screen* screen, float filter_radius) {
+    m_shader->UseVariant(m_upsample);
+    m_shader->Start();
+    m_shader->SetFloat(m_filter_radius, filter_radius);
+    m_shader->SetVec2(m_region, region);
+
+    source->Bind(GL_TEXTURE0);
+    screen->Draw();
+}
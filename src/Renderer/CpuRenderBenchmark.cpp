@@ -0,0 +1,100 @@
+#include "Renderer/CpuRenderBenchmark.hpp"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "GUI/TransferFunctionWidget.hpp"
+#include "Model/Volume.hpp"
+#include "Renderer/CpuVolumeRenderer.hpp"
+#include "Utility/Logger.hpp"
+#include "Utility/ThreadPool.hpp"
+
+namespace {
+    std::string ShowStatistics(const CpuVolumeRenderer::Statistics& statistics) {
+        return std::to_string(statistics.seconds * 1000.0) + " ms, "
+               + std::to_string(statistics.RaysPerSecond() / 1.0e6) + " Mrays/s, "
+               + std::to_string(static_cast<double>(statistics.samples) / static_cast<double>(statistics.rays)) + " samples/ray, "
+               + std::to_string(statistics.steals) + " / " + std::to_string(statistics.tiles) + " tiles stolen";
+    }
+}
+
+int CpuRenderBenchmark::Run(const Config& config) {
+    Logger::Message(LogLevel::Info, "CPU rendering: " + config.benchmark_volume + " with " + config.benchmark_transfer_function);
+    const Volume volume(config.benchmark_volume, "", RawLoadMethod::MemoryMapped);
+    if (!volume.IsLoaded()) {
+        return 1;
+    }
+
+    TransferFunctionWidget transfer_function;
+    if (!transfer_function.LoadPreset(config.benchmark_transfer_function)) {
+        return 1;
+    }
+    const CpuVolumeRenderer renderer(volume, transfer_function.GetColorData());
+
+    // The whole volume in view from the front, the light follows the camera like in the application.
+    CpuRenderSettings settings;
+    settings.width = config.width;
+    settings.height = config.height;
+    const glm::vec3 actual_resolution = volume.m_info.resolution.GetVec3() * volume.m_info.voxel_size;
+    const float distance = glm::length(actual_resolution) * 0.5f / std::tan(glm::radians(settings.fov) * 0.5f) * 1.1f;
+    settings.camera_position = glm::vec3(0.0f, 0.0f, distance);
+    settings.light_position = settings.camera_position;
+
+    std::vector<glm::vec4> image;
+    const CpuVolumeRenderer::Statistics statistics = renderer.Render(settings, ThreadPool::Shared(), image);
+    Logger::Message(LogLevel::Info, std::to_string(settings.width) + "x" + std::to_string(settings.height) + " with "
+                                    + std::to_string(ThreadPool::Shared().Size()) + " threads: " + ShowStatistics(statistics));
+    if (!CpuVolumeRenderer::WritePNG(config.cpu_render_image, image, settings.width, settings.height)) {
+        Logger::Message(LogLevel::Error, "Failed to write the image: " + config.cpu_render_image);
+        return 1;
+    }
+    Logger::Message(LogLevel::Info, "Image written to " + config.cpu_render_image);
+
+    // The same frame with the per-lane loop, for the gain of the vector lanes
+    if (settings.simd_level != Maths::SimdLevel::Scalar) {
+        CpuRenderSettings scalar_settings = settings;
+        scalar_settings.simd_level = Maths::SimdLevel::Scalar;
+        std::vector<glm::vec4> scalar_image;
+        const CpuVolumeRenderer::Statistics scalar = renderer.Render(scalar_settings, ThreadPool::Shared(), scalar_image);
+        Logger::Message(LogLevel::Info, "Scalar lanes: " + ShowStatistics(scalar) + ", packet speedup x"
+                                        + std::to_string(statistics.RaysPerSecond() / std::max(scalar.RaysPerSecond(), 1.0)));
+    }
+
+    if (!config.cpu_render_scaling) {
+        return 0;
+    }
+
+    // 1, 2, 4, ... and every hardware thread, the best of a few renders each.
+    const unsigned int hardware_threads = ThreadPool::HardwareThreads();
+    std::vector<unsigned int> thread_counts;
+    for (unsigned int threads = 1; threads < hardware_threads; threads *= 2) {
+        thread_counts.push_back(threads);
+    }
+    thread_counts.push_back(hardware_threads);
+
+    const int repeat = 3;
+    double single_thread_rate = 0.0;
+    for (const unsigned int threads : thread_counts) {
+        ThreadPool pool(threads);
+        CpuVolumeRenderer::Statistics best;
+        for (int r = 0; r < repeat; r++) {
+            const CpuVolumeRenderer::Statistics current = renderer.Render(settings, pool, image);
+            if (r == 0 || current.seconds < best.seconds) {
+                best = current;
+            }
+        }
+
+        if (threads == 1) {
+            single_thread_rate = best.RaysPerSecond();
+        }
+        const double speedup = single_thread_rate > 0.0 ? best.RaysPerSecond() / single_thread_rate : 0.0;
+        Logger::Message(LogLevel::Info, std::to_string(threads) + " threads: " + ShowStatistics(best) + ", "
+                                        + "speedup x" + std::to_string(speedup) + ", "
+                                        + "efficiency " + std::to_string(speedup / threads * 100.0) + "%");
+    }
+    return 0;
+}
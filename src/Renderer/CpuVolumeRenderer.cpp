@@ -0,0 +1,538 @@
+#include "Renderer/CpuVolumeRenderer.hpp"
+
+#include <stb_image_write.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <bitset>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+#include "Maths/Octahedral.hpp"
+#include "Utility/WorkStealingScheduler.hpp"
+
+// The same split as GradientKernel: vector lanes only on x86-64, AVX2 functions are marked for GCC and Clang
+#if defined(__x86_64__) || defined(_M_X64)
+    #define CPU_RENDERER_X86
+    #include <immintrin.h>
+#endif
+
+#if defined(CPU_RENDERER_X86) && (defined(__GNUC__) || defined(__clang__))
+    #define CPU_RENDERER_AVX2 __attribute__((target("avx2")))
+#else
+    #define CPU_RENDERER_AVX2
+#endif
+
+// The rays of one packet in structure-of-arrays form, the camera (ray origin) is shared.
+struct CpuVolumeRenderer::RayPacket {
+    alignas(32) float direction_x[PacketSize];
+    alignas(32) float direction_y[PacketSize];
+    alignas(32) float direction_z[PacketSize];
+    alignas(32) float t[PacketSize];
+    alignas(32) float t_exit[PacketSize];
+    alignas(32) float r[PacketSize];
+    alignas(32) float g[PacketSize];
+    alignas(32) float b[PacketSize];
+    alignas(32) float a[PacketSize];
+    alignas(32) float x[PacketSize];
+    alignas(32) float y[PacketSize];
+    alignas(32) float z[PacketSize];
+    bool active[PacketSize];
+    glm::vec3 origin;
+};
+
+double CpuVolumeRenderer::Statistics::RaysPerSecond() const {
+    return seconds > 0.0 ? static_cast<double>(rays) / seconds : 0.0;
+}
+
+CpuVolumeRenderer::CpuVolumeRenderer(const Volume& volume, const std::vector<float>& colormap) :
+    m_resolution(volume.m_info.resolution),
+    m_actual_resolution(volume.m_info.resolution.GetVec3() * volume.m_info.voxel_size),
+    m_colormap(colormap) {
+    // Same values as the shader samples, converted once so the rays do not depend on the sample type.
+    m_values.resize(volume.GetVoxelCount());
+    const float max_value = volume.m_max_value;
+    DispatchSampleType(volume.m_info.sample_type, [&](auto tag) {
+        using T = typename decltype(tag)::type;
+        const std::vector<T>& voxels = volume.GetVoxels<T>();
+        const int count = static_cast<int>(voxels.size());
+        ThreadPool::Shared().ParallelFor(0, count, 1 << 18, [&](int begin, int end) {
+            for (int n = begin; n < end; n++) {
+                m_values[n] = static_cast<float>(voxels[n]) / max_value;
+            }
+        });
+    });
+}
+
+// Trilinear filtering with GL_CLAMP_TO_EDGE, texel centers at (i + 0.5) / res.
+float CpuVolumeRenderer::SampleValue(const glm::vec3& position) const {
+    const float fx = position.x * static_cast<float>(m_resolution.x) - 0.5f;
+    const float fy = position.y * static_cast<float>(m_resolution.y) - 0.5f;
+    const float fz = position.z * static_cast<float>(m_resolution.z) - 0.5f;
+    const float x_floor = std::floor(fx), y_floor = std::floor(fy), z_floor = std::floor(fz);
+    const float tx = fx - x_floor, ty = fy - y_floor, tz = fz - z_floor;
+
+    const auto clamp_index = [](float index, int res) { return std::clamp(static_cast<int>(index), 0, res - 1); };
+    const int x0 = clamp_index(x_floor, m_resolution.x), x1 = clamp_index(x_floor + 1.0f, m_resolution.x);
+    const int y0 = clamp_index(y_floor, m_resolution.y), y1 = clamp_index(y_floor + 1.0f, m_resolution.y);
+    const int z0 = clamp_index(z_floor, m_resolution.z), z1 = clamp_index(z_floor + 1.0f, m_resolution.z);
+
+    const std::size_t slice = static_cast<std::size_t>(m_resolution.x) * m_resolution.y;
+    const auto value = [&](int x, int y, int z) { return m_values[z * slice + static_cast<std::size_t>(y) * m_resolution.x + x]; };
+    const float c00 = value(x0, y0, z0) + (value(x1, y0, z0) - value(x0, y0, z0)) * tx;
+    const float c10 = value(x0, y1, z0) + (value(x1, y1, z0) - value(x0, y1, z0)) * tx;
+    const float c01 = value(x0, y0, z1) + (value(x1, y0, z1) - value(x0, y0, z1)) * tx;
+    const float c11 = value(x0, y1, z1) + (value(x1, y1, z1) - value(x0, y1, z1)) * tx;
+    const float c0 = c00 + (c10 - c00) * ty;
+    const float c1 = c01 + (c11 - c01) * ty;
+    return c0 + (c1 - c0) * tz;
+}
+
+// Central differences one voxel apart: inside the volume this is the trilinear interpolation of the
+// per-voxel gradients of Gradient::Compute(), which is what the normal textures hold.
+glm::vec3 CpuVolumeRenderer::SampleNormal(const glm::vec3& position) const {
+    const glm::vec3 voxel = 1.0f / m_resolution.GetVec3();
+    const glm::vec3 gradient(
+        (SampleValue(position + glm::vec3(voxel.x, 0.0f, 0.0f)) - SampleValue(position - glm::vec3(voxel.x, 0.0f, 0.0f))) * voxel.x * 0.5f,
+        (SampleValue(position + glm::vec3(0.0f, voxel.y, 0.0f)) - SampleValue(position - glm::vec3(0.0f, voxel.y, 0.0f))) * voxel.y * 0.5f,
+        (SampleValue(position + glm::vec3(0.0f, 0.0f, voxel.z)) - SampleValue(position - glm::vec3(0.0f, 0.0f, voxel.z))) * voxel.z * 0.5f
+    );
+
+    // A homogeneous region has no direction (normalize() of it is undefined in the shader), it is shaded as facing +z.
+    const glm::vec3 unit = Maths::Octahedral::Normalize(gradient);
+    return unit == glm::vec3(0.0f) ? glm::vec3(0.0f, 0.0f, 1.0f) : unit;
+}
+
+// The 1D transfer function texture, linearly filtered and clamped to the edge.
+glm::vec4 CpuVolumeRenderer::Classify(float value) const {
+    const int texel_count = static_cast<int>(m_colormap.size() / 4);
+    const float u = std::clamp(value, 0.0f, 1.0f) * static_cast<float>(texel_count) - 0.5f;
+    const float u_floor = std::floor(u);
+    const float t = u - u_floor;
+    const int i0 = std::clamp(static_cast<int>(u_floor), 0, texel_count - 1);
+    const int i1 = std::clamp(static_cast<int>(u_floor) + 1, 0, texel_count - 1);
+    const float* c0 = m_colormap.data() + i0 * 4;
+    const float* c1 = m_colormap.data() + i1 * 4;
+    return glm::vec4(c0[0] + (c1[0] - c0[0]) * t, c0[1] + (c1[1] - c0[1]) * t,
+                     c0[2] + (c1[2] - c0[2]) * t, c0[3] + (c1[3] - c0[3]) * t);
+}
+
+glm::vec3 CpuVolumeRenderer::BlinnPhongShading(const glm::vec3& normal, const glm::vec3& color, const glm::vec3& position,
+                                               const CpuRenderSettings& settings) const {
+    // Ambient
+    const float ambient_strength = 0.2f;
+    const glm::vec3 ambient = ambient_strength * settings.light_color;
+
+    // Diffuse
+    const float diffuse_strength = 0.75f;
+    glm::vec3 norm = glm::normalize(normal);
+    const glm::vec3 light_direction = glm::normalize(settings.light_position - position);
+    float diff = glm::dot(norm, light_direction);
+    if (diff <= 0.0f) {
+        diff *= -1.0f;
+        norm = -norm;
+    }
+    const glm::vec3 diffuse = diffuse_strength * diff * settings.light_color;
+
+    // Specular
+    const float specular_strength = 0.4f;
+    const glm::vec3 view_direction = glm::normalize(settings.camera_position - position);
+    const glm::vec3 halfway = glm::normalize(light_direction + view_direction);
+    const float spec = std::pow(std::max(glm::dot(norm, halfway), 0.0f), settings.shininess);
+    const glm::vec3 specular = specular_strength * spec * settings.light_color;
+
+    return glm::clamp((ambient + diffuse + specular) * color, glm::vec3(0.0f), glm::vec3(1.0f));
+}
+
+std::size_t CpuVolumeRenderer::TracePacket(RayPacket& packet, const CpuRenderSettings& settings) const {
+    const float step = settings.sample_rate;
+    std::size_t samples = 0;
+
+    bool any_active = true;
+    while (any_active) {
+        // Sample positions of the whole packet
+        for (int n = 0; n < PacketSize; n++) {
+            packet.x[n] = packet.origin.x + packet.direction_x[n] * packet.t[n];
+            packet.y[n] = packet.origin.y + packet.direction_y[n] * packet.t[n];
+            packet.z[n] = packet.origin.z + packet.direction_z[n] * packet.t[n];
+        }
+
+        any_active = false;
+        for (int n = 0; n < PacketSize; n++) {
+            if (!packet.active[n]) {
+                continue;
+            }
+            const glm::vec3 sample_pos(packet.x[n], packet.y[n], packet.z[n]);
+            samples++;
+
+            glm::vec4 volume_color = Classify(SampleValue(sample_pos));
+            if (volume_color.a > 0.0f) {
+                if (settings.use_opacity_correction) {
+                    volume_color.a = 1.0f - std::pow(std::max(1.0f - volume_color.a, 0.0f), step / settings.opacity_reference_step);
+                }
+
+                glm::vec3 color;
+                if (settings.use_lighting) {
+                    const glm::vec3 current_pos = sample_pos * m_actual_resolution - m_actual_resolution / 2.0f;
+                    color = BlinnPhongShading(SampleNormal(sample_pos), glm::vec3(volume_color), current_pos, settings);
+                } else {
+                    color = glm::vec3(volume_color) * 2.0f;
+                }
+
+                const float weight = (1.0f - packet.a[n]) * volume_color.a;
+                packet.r[n] += weight * color.r;
+                packet.g[n] += weight * color.g;
+                packet.b[n] += weight * color.b;
+                packet.a[n] += weight;
+            }
+
+            // Early ray termination, the same threshold as the shader
+            packet.t[n] += step;
+            packet.active[n] = packet.t[n] < packet.t_exit[n] && packet.a[n] <= 0.99f;
+            any_active = any_active || packet.active[n];
+        }
+    }
+    return samples;
+}
+
+bool CpuVolumeRenderer::UsesAVX2(const CpuRenderSettings& settings) const {
+#ifdef CPU_RENDERER_X86
+    const std::size_t max_index = static_cast<std::size_t>(std::numeric_limits<int>::max());
+    return settings.simd_level == Maths::SimdLevel::AVX2 && Maths::GradientKernel::Detect() == Maths::SimdLevel::AVX2
+           && m_values.size() <= max_index && m_colormap.size() <= max_index && !m_colormap.empty();
+#else
+    return false;
+#endif
+}
+
+#ifdef CPU_RENDERER_X86
+namespace {
+    // A vec3 of eight lanes
+    struct Vec3x8 {
+        __m256 x, y, z;
+    };
+
+    CPU_RENDERER_AVX2 inline Vec3x8 Add(const Vec3x8& a, const Vec3x8& b) {
+        return { _mm256_add_ps(a.x, b.x), _mm256_add_ps(a.y, b.y), _mm256_add_ps(a.z, b.z) };
+    }
+
+    CPU_RENDERER_AVX2 inline Vec3x8 Sub(const Vec3x8& a, const Vec3x8& b) {
+        return { _mm256_sub_ps(a.x, b.x), _mm256_sub_ps(a.y, b.y), _mm256_sub_ps(a.z, b.z) };
+    }
+
+    CPU_RENDERER_AVX2 inline Vec3x8 Broadcast(const glm::vec3& v) {
+        return { _mm256_set1_ps(v.x), _mm256_set1_ps(v.y), _mm256_set1_ps(v.z) };
+    }
+
+    CPU_RENDERER_AVX2 inline __m256 Dot(const Vec3x8& a, const Vec3x8& b) {
+        return _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(a.x, b.x), _mm256_mul_ps(a.y, b.y)), _mm256_mul_ps(a.z, b.z));
+    }
+
+    // glm::normalize: v * inversesqrt(dot(v, v))
+    CPU_RENDERER_AVX2 inline Vec3x8 Normalize(const Vec3x8& v) {
+        const __m256 inverse_length = _mm256_div_ps(_mm256_set1_ps(1.0f), _mm256_sqrt_ps(Dot(v, v)));
+        return { _mm256_mul_ps(v.x, inverse_length), _mm256_mul_ps(v.y, inverse_length), _mm256_mul_ps(v.z, inverse_length) };
+    }
+
+    CPU_RENDERER_AVX2 inline __m256i ClampIndex(__m256 index, int res) {
+        const __m256i integer = _mm256_cvttps_epi32(index);
+        return _mm256_min_epi32(_mm256_max_epi32(integer, _mm256_setzero_si256()), _mm256_set1_epi32(res - 1));
+    }
+
+    CPU_RENDERER_AVX2 inline __m256 Lerp(__m256 a, __m256 b, __m256 t) {
+        return _mm256_add_ps(a, _mm256_mul_ps(_mm256_sub_ps(b, a), t));
+    }
+
+    // Lambdas do not inherit the target attribute, so the lane helpers are plain functions.
+    CPU_RENDERER_AVX2 inline __m256 Gather(const float* values, __m256i z, __m256i y, __m256i x) {
+        return _mm256_i32gather_ps(values, _mm256_add_epi32(_mm256_add_epi32(z, y), x), 4);
+    }
+
+    // CpuVolumeRenderer::SampleValue() of eight positions, the eight corners are gathered.
+    CPU_RENDERER_AVX2 __m256 SampleValue8(const float* values, const Maths::ivec3& res, const Vec3x8& position) {
+        const __m256 half = _mm256_set1_ps(0.5f), one = _mm256_set1_ps(1.0f);
+        const __m256 fx = _mm256_sub_ps(_mm256_mul_ps(position.x, _mm256_set1_ps(static_cast<float>(res.x))), half);
+        const __m256 fy = _mm256_sub_ps(_mm256_mul_ps(position.y, _mm256_set1_ps(static_cast<float>(res.y))), half);
+        const __m256 fz = _mm256_sub_ps(_mm256_mul_ps(position.z, _mm256_set1_ps(static_cast<float>(res.z))), half);
+        const __m256 x_floor = _mm256_floor_ps(fx), y_floor = _mm256_floor_ps(fy), z_floor = _mm256_floor_ps(fz);
+        const __m256 tx = _mm256_sub_ps(fx, x_floor), ty = _mm256_sub_ps(fy, y_floor), tz = _mm256_sub_ps(fz, z_floor);
+
+        const __m256i x0 = ClampIndex(x_floor, res.x), x1 = ClampIndex(_mm256_add_ps(x_floor, one), res.x);
+        const __m256i y0 = ClampIndex(y_floor, res.y), y1 = ClampIndex(_mm256_add_ps(y_floor, one), res.y);
+        const __m256i z0 = ClampIndex(z_floor, res.z), z1 = ClampIndex(_mm256_add_ps(z_floor, one), res.z);
+
+        const __m256i row = _mm256_set1_epi32(res.x), slice = _mm256_set1_epi32(res.x * res.y);
+        const __m256i y0_row = _mm256_mullo_epi32(y0, row), y1_row = _mm256_mullo_epi32(y1, row);
+        const __m256i z0_slice = _mm256_mullo_epi32(z0, slice), z1_slice = _mm256_mullo_epi32(z1, slice);
+        const __m256 v000 = Gather(values, z0_slice, y0_row, x0), v100 = Gather(values, z0_slice, y0_row, x1);
+        const __m256 v010 = Gather(values, z0_slice, y1_row, x0), v110 = Gather(values, z0_slice, y1_row, x1);
+        const __m256 v001 = Gather(values, z1_slice, y0_row, x0), v101 = Gather(values, z1_slice, y0_row, x1);
+        const __m256 v011 = Gather(values, z1_slice, y1_row, x0), v111 = Gather(values, z1_slice, y1_row, x1);
+        const __m256 c00 = Lerp(v000, v100, tx), c10 = Lerp(v010, v110, tx);
+        const __m256 c01 = Lerp(v001, v101, tx), c11 = Lerp(v011, v111, tx);
+        return Lerp(Lerp(c00, c10, ty), Lerp(c01, c11, ty), tz);
+    }
+
+    // One channel of the transfer function between the texels i0 and i1 (already times 4)
+    CPU_RENDERER_AVX2 inline __m256 ColormapChannel(const float* colormap, int c, __m256i i0, __m256i i1, __m256 t) {
+        return Lerp(_mm256_i32gather_ps(colormap + c, i0, 4), _mm256_i32gather_ps(colormap + c, i1, 4), t);
+    }
+
+    // One component of the central difference gradient
+    CPU_RENDERER_AVX2 inline __m256 Difference(const float* values, const Maths::ivec3& res, const Vec3x8& position, const Vec3x8& offset,
+                                               float voxel) {
+        const __m256 difference = _mm256_sub_ps(SampleValue8(values, res, Add(position, offset)), SampleValue8(values, res, Sub(position, offset)));
+        return _mm256_mul_ps(_mm256_mul_ps(difference, _mm256_set1_ps(voxel)), _mm256_set1_ps(0.5f));
+    }
+
+    // (ambient + diffuse + specular) * color, clamped, one channel
+    CPU_RENDERER_AVX2 inline __m256 Shade(__m256 light, __m256 diffuse, __m256 specular, __m256 color) {
+        const __m256 sum = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(0.2f), light), _mm256_mul_ps(diffuse, light)),
+                                         _mm256_mul_ps(specular, light));
+        return _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(sum, color), _mm256_setzero_ps()), _mm256_set1_ps(1.0f));
+    }
+
+    // pow() has no AVX2 instruction, it is the only part done lane by lane.
+    CPU_RENDERER_AVX2 inline __m256 Pow8(__m256 base, float exponent, __m256 mask) {
+        alignas(32) float lanes[8];
+        _mm256_store_ps(lanes, base);
+        const int bits = _mm256_movemask_ps(mask);
+        for (int n = 0; n < 8; n++) {
+            lanes[n] = (bits >> n & 1) != 0 ? std::pow(lanes[n], exponent) : 0.0f;
+        }
+        return _mm256_load_ps(lanes);
+    }
+}
+
+CPU_RENDERER_AVX2
+std::size_t CpuVolumeRenderer::TracePacketAVX2(RayPacket& packet, const CpuRenderSettings& settings) const {
+    static_assert(PacketSize == 8, "The AVX2 lanes are one packet");
+    const __m256 zero = _mm256_setzero_ps(), one = _mm256_set1_ps(1.0f), sign = _mm256_set1_ps(-0.0f);
+    const __m256 step = _mm256_set1_ps(settings.sample_rate);
+    const float* values = m_values.data();
+    const int texel_count = static_cast<int>(m_colormap.size() / 4);
+    const float opacity_exponent = settings.sample_rate / settings.opacity_reference_step;
+
+    // Constants of the shading
+    const Vec3x8 origin = Broadcast(packet.origin);
+    const Vec3x8 actual_resolution = Broadcast(m_actual_resolution);
+    const Vec3x8 half_resolution = Broadcast(m_actual_resolution / 2.0f);
+    const Vec3x8 light_position = Broadcast(settings.light_position);
+    const Vec3x8 camera_position = Broadcast(settings.camera_position);
+    const Vec3x8 light_color = Broadcast(settings.light_color);
+    const glm::vec3 voxel = 1.0f / m_resolution.GetVec3();
+
+    const Vec3x8 direction = { _mm256_load_ps(packet.direction_x), _mm256_load_ps(packet.direction_y), _mm256_load_ps(packet.direction_z) };
+    const __m256 t_exit = _mm256_load_ps(packet.t_exit);
+    __m256 t = _mm256_load_ps(packet.t);
+    __m256 r = _mm256_load_ps(packet.r), g = _mm256_load_ps(packet.g), b = _mm256_load_ps(packet.b), a = _mm256_load_ps(packet.a);
+    alignas(32) std::int32_t active_lanes[PacketSize];
+    for (int n = 0; n < PacketSize; n++) {
+        active_lanes[n] = packet.active[n] ? -1 : 0;
+    }
+    __m256 active = _mm256_castsi256_ps(_mm256_load_si256(reinterpret_cast<const __m256i*>(active_lanes)));
+
+    std::size_t samples = 0;
+    while (_mm256_movemask_ps(active) != 0) {
+        samples += std::bitset<PacketSize>(static_cast<unsigned int>(_mm256_movemask_ps(active))).count();
+        const Vec3x8 sample_pos = { _mm256_add_ps(origin.x, _mm256_mul_ps(direction.x, t)),
+                                    _mm256_add_ps(origin.y, _mm256_mul_ps(direction.y, t)),
+                                    _mm256_add_ps(origin.z, _mm256_mul_ps(direction.z, t)) };
+
+        // Classify(): the transfer function, linearly filtered and clamped to the edge
+        const __m256 value = _mm256_min_ps(_mm256_max_ps(SampleValue8(values, m_resolution, sample_pos), zero), one);
+        const __m256 u = _mm256_sub_ps(_mm256_mul_ps(value, _mm256_set1_ps(static_cast<float>(texel_count))), _mm256_set1_ps(0.5f));
+        const __m256 u_floor = _mm256_floor_ps(u);
+        const __m256 u_t = _mm256_sub_ps(u, u_floor);
+        const __m256i last_texel = _mm256_set1_epi32(texel_count - 1);
+        const __m256i u_index = _mm256_cvttps_epi32(u_floor);
+        const __m256i i0 = _mm256_slli_epi32(_mm256_min_epi32(_mm256_max_epi32(u_index, _mm256_setzero_si256()), last_texel), 2);
+        const __m256i i1 = _mm256_slli_epi32(_mm256_min_epi32(_mm256_max_epi32(_mm256_add_epi32(u_index, _mm256_set1_epi32(1)),
+                                                                                _mm256_setzero_si256()), last_texel), 2);
+        const float* colormap = m_colormap.data();
+        Vec3x8 color = { ColormapChannel(colormap, 0, i0, i1, u_t), ColormapChannel(colormap, 1, i0, i1, u_t),
+                         ColormapChannel(colormap, 2, i0, i1, u_t) };
+        __m256 alpha = ColormapChannel(colormap, 3, i0, i1, u_t);
+
+        // Lanes which composite this step, the others keep their values
+        const __m256 visible = _mm256_and_ps(active, _mm256_cmp_ps(alpha, zero, _CMP_GT_OQ));
+        if (_mm256_movemask_ps(visible) != 0) {
+            if (settings.use_opacity_correction) {
+                const __m256 transparency = _mm256_max_ps(_mm256_sub_ps(one, alpha), zero);
+                alpha = _mm256_sub_ps(one, Pow8(transparency, opacity_exponent, visible));
+            }
+
+            if (settings.use_lighting) {
+                // SampleNormal(): central differences one voxel apart
+                const Vec3x8 dx = { _mm256_set1_ps(voxel.x), zero, zero };
+                const Vec3x8 dy = { zero, _mm256_set1_ps(voxel.y), zero };
+                const Vec3x8 dz = { zero, zero, _mm256_set1_ps(voxel.z) };
+                const Vec3x8 gradient = { Difference(values, m_resolution, sample_pos, dx, voxel.x),
+                                          Difference(values, m_resolution, sample_pos, dy, voxel.y),
+                                          Difference(values, m_resolution, sample_pos, dz, voxel.z) };
+                const __m256 length = _mm256_sqrt_ps(Dot(gradient, gradient));
+                const __m256 has_direction = _mm256_cmp_ps(length, zero, _CMP_GT_OQ);
+                const Vec3x8 unit = { _mm256_and_ps(_mm256_div_ps(gradient.x, length), has_direction),
+                                      _mm256_and_ps(_mm256_div_ps(gradient.y, length), has_direction),
+                                      _mm256_blendv_ps(one, _mm256_div_ps(gradient.z, length), has_direction) };
+
+                // BlinnPhongShading()
+                const Vec3x8 current_pos = Sub(Vec3x8 { _mm256_mul_ps(sample_pos.x, actual_resolution.x), _mm256_mul_ps(sample_pos.y, actual_resolution.y),
+                                                        _mm256_mul_ps(sample_pos.z, actual_resolution.z) }, half_resolution);
+                Vec3x8 norm = Normalize(unit);
+                const Vec3x8 light_direction = Normalize(Sub(light_position, current_pos));
+                __m256 diff = Dot(norm, light_direction);
+                const __m256 back = _mm256_and_ps(_mm256_cmp_ps(diff, zero, _CMP_LE_OQ), sign);
+                diff = _mm256_xor_ps(diff, back);
+                norm = { _mm256_xor_ps(norm.x, back), _mm256_xor_ps(norm.y, back), _mm256_xor_ps(norm.z, back) };
+
+                const Vec3x8 view_direction = Normalize(Sub(camera_position, current_pos));
+                const Vec3x8 halfway = Normalize(Add(light_direction, view_direction));
+                const __m256 spec = Pow8(_mm256_max_ps(Dot(norm, halfway), zero), settings.shininess, visible);
+
+                const __m256 diffuse = _mm256_mul_ps(_mm256_set1_ps(0.75f), diff);
+                const __m256 specular = _mm256_mul_ps(_mm256_set1_ps(0.4f), spec);
+                color = { Shade(light_color.x, diffuse, specular, color.x), Shade(light_color.y, diffuse, specular, color.y),
+                          Shade(light_color.z, diffuse, specular, color.z) };
+            } else {
+                const __m256 two = _mm256_set1_ps(2.0f);
+                color = { _mm256_mul_ps(color.x, two), _mm256_mul_ps(color.y, two), _mm256_mul_ps(color.z, two) };
+            }
+
+            const __m256 weight = _mm256_mul_ps(_mm256_sub_ps(one, a), alpha);
+            r = _mm256_blendv_ps(r, _mm256_add_ps(r, _mm256_mul_ps(weight, color.x)), visible);
+            g = _mm256_blendv_ps(g, _mm256_add_ps(g, _mm256_mul_ps(weight, color.y)), visible);
+            b = _mm256_blendv_ps(b, _mm256_add_ps(b, _mm256_mul_ps(weight, color.z)), visible);
+            a = _mm256_blendv_ps(a, _mm256_add_ps(a, weight), visible);
+        }
+
+        // Early ray termination, the same threshold as the shader
+        t = _mm256_blendv_ps(t, _mm256_add_ps(t, step), active);
+        active = _mm256_and_ps(active, _mm256_and_ps(_mm256_cmp_ps(t, t_exit, _CMP_LT_OQ), _mm256_cmp_ps(a, _mm256_set1_ps(0.99f), _CMP_LE_OQ)));
+    }
+
+    _mm256_store_ps(packet.t, t);
+    _mm256_store_ps(packet.r, r);
+    _mm256_store_ps(packet.g, g);
+    _mm256_store_ps(packet.b, b);
+    _mm256_store_ps(packet.a, a);
+    for (int n = 0; n < PacketSize; n++) {
+        packet.active[n] = false;
+    }
+    return samples;
+}
+#else
+std::size_t CpuVolumeRenderer::TracePacketAVX2(RayPacket& packet, const CpuRenderSettings& settings) const {
+    return TracePacket(packet, settings);
+}
+#endif
+
+CpuVolumeRenderer::Statistics CpuVolumeRenderer::Render(const CpuRenderSettings& settings, ThreadPool& pool,
+                                                        std::vector<glm::vec4>& image) const {
+    auto start = std::chrono::steady_clock::now();
+    const int width = settings.width;
+    const int height = settings.height;
+    image.assign(static_cast<std::size_t>(width) * height, glm::vec4(0.0f));
+
+    // The camera of Camera::View() and Camera::Perspective()
+    const glm::vec3 front = glm::normalize(settings.camera_target - settings.camera_position);
+    const glm::vec3 right = glm::normalize(glm::cross(front, settings.world_up));
+    const glm::vec3 up = glm::cross(right, front);
+    const float tan_half_fov = std::tan(glm::radians(settings.fov) * 0.5f);
+    const float aspect = static_cast<float>(width) / static_cast<float>(height);
+    const glm::vec3 camera_in_texture = (settings.camera_position + m_actual_resolution * 0.5f) / m_actual_resolution;
+
+    const int tiles_x = (width + TileSize - 1) / TileSize;
+    const int tiles_y = (height + TileSize - 1) / TileSize;
+    std::atomic<std::size_t> samples { 0 };
+    const bool use_avx2 = UsesAVX2(settings);
+
+    const auto render_tile = [&](int tile, int) {
+        const int tile_x = (tile % tiles_x) * TileSize;
+        const int tile_y = (tile / tiles_x) * TileSize;
+        std::size_t tile_samples = 0;
+        RayPacket packet;
+        packet.origin = camera_in_texture;
+
+        for (int py = tile_y; py < std::min(tile_y + TileSize, height); py += PacketHeight) {
+            for (int px = tile_x; px < std::min(tile_x + TileSize, width); px += PacketWidth) {
+                // Ray setup of every lane: the slab intersection with [0, 1]^3 in texture space, as in volume.frag
+                for (int n = 0; n < PacketSize; n++) {
+                    const int x = px + n % PacketWidth;
+                    const int y = py + n / PacketWidth;
+                    packet.r[n] = settings.background_color.r;
+                    packet.g[n] = settings.background_color.g;
+                    packet.b[n] = settings.background_color.b;
+                    packet.a[n] = 0.0f;
+                    packet.t[n] = 0.0f;
+                    packet.t_exit[n] = 0.0f;
+                    packet.active[n] = false;
+                    packet.direction_x[n] = 0.0f;
+                    packet.direction_y[n] = 0.0f;
+                    packet.direction_z[n] = 0.0f;
+                    if (x >= width || y >= height) {
+                        continue;
+                    }
+
+                    const float ndc_x = (2.0f * (static_cast<float>(x) + 0.5f) / static_cast<float>(width) - 1.0f) * tan_half_fov * aspect;
+                    const float ndc_y = (1.0f - 2.0f * (static_cast<float>(y) + 0.5f) / static_cast<float>(height)) * tan_half_fov;
+                    const glm::vec3 ray_direction = glm::normalize(front + ndc_x * right + ndc_y * up);
+                    const glm::vec3 direction_in_texture = ray_direction / m_actual_resolution;
+                    packet.direction_x[n] = direction_in_texture.x;
+                    packet.direction_y[n] = direction_in_texture.y;
+                    packet.direction_z[n] = direction_in_texture.z;
+
+                    glm::vec3 inverse_direction;
+                    for (int axis = 0; axis < 3; axis++) {
+                        const float d = direction_in_texture[axis];
+                        inverse_direction[axis] = 1.0f / (std::abs(d) < 1e-8f ? 1e-8f : d);
+                    }
+                    const glm::vec3 t_near = (glm::vec3(0.0f) - camera_in_texture) * inverse_direction;
+                    const glm::vec3 t_far = (glm::vec3(1.0f) - camera_in_texture) * inverse_direction;
+                    const glm::vec3 t_min = glm::min(t_near, t_far);
+                    const glm::vec3 t_max = glm::max(t_near, t_far);
+                    const float t_enter = std::max(std::max(std::max(t_min.x, t_min.y), t_min.z), 0.0f);
+                    const float t_exit = std::min(std::min(t_max.x, t_max.y), t_max.z);
+
+                    packet.t[n] = t_enter;
+                    packet.t_exit[n] = t_exit;
+                    packet.active[n] = t_enter < t_exit;
+                }
+
+                tile_samples += use_avx2 ? TracePacketAVX2(packet, settings) : TracePacket(packet, settings);
+
+                for (int n = 0; n < PacketSize; n++) {
+                    const int x = px + n % PacketWidth;
+                    const int y = py + n / PacketWidth;
+                    if (x < width && y < height) {
+                        image[static_cast<std::size_t>(y) * width + x] = glm::vec4(packet.r[n], packet.g[n], packet.b[n], packet.a[n]);
+                    }
+                }
+            }
+        }
+        samples.fetch_add(tile_samples, std::memory_order_relaxed);
+    };
+
+    const WorkStealingScheduler::Statistics scheduling = WorkStealingScheduler::Run(pool, tiles_x * tiles_y, render_tile);
+
+    Statistics statistics;
+    statistics.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    statistics.rays = static_cast<std::size_t>(width) * height;
+    statistics.samples = samples.load();
+    statistics.tiles = scheduling.tasks;
+    statistics.steals = scheduling.steals;
+    return statistics;
+}
+
+bool CpuVolumeRenderer::WritePNG(const std::string& file_path, const std::vector<glm::vec4>& image, int width, int height) {
+    // Opaque RGB like the screen: the color already contains the background.
+    std::vector<uint8_t> pixels(image.size() * 3);
+    for (std::size_t n = 0; n < image.size(); n++) {
+        for (int c = 0; c < 3; c++) {
+            pixels[n * 3 + c] = static_cast<uint8_t>(std::clamp(image[n][c], 0.0f, 1.0f) * 255.0f + 0.5f);
+        }
+    }
+    return stbi_write_png(file_path.c_str(), width, height, 3, pixels.data(), width * 3) != 0;
+}
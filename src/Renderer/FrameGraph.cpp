@@ -0,0 +1,164 @@
+#include "Renderer/FrameGraph.hpp"
+
+#include <algorithm>
+#include <string>
+#include <utility>
+
+#include "Utility/Logger.hpp"
+
+void FrameGraph::Clear() {
+    for (Resource& resource : m_resources) {
+        Release(resource);
+    }
+    m_resources.clear();
+    m_passes.clear();
+}
+
+FrameResource FrameGraph::Import(const char* name, const RenderTarget* target) {
+    m_resources.push_back({ name, target, 0, 0, false, -1, -1, 0, -1 });
+    return static_cast<FrameResource>(m_resources.size() - 1);
+}
+
+FrameResource FrameGraph::Create(const char* name, int width, int height, bool retained) {
+    m_resources.push_back({ name, nullptr, width, height, retained, -1, -1, 0, -1 });
+    return static_cast<FrameResource>(m_resources.size() - 1);
+}
+
+void FrameGraph::Resize(FrameResource resource, int width, int height) {
+    Resource& entry = m_resources[resource];
+    if (entry.width != width || entry.height != height) {
+        Release(entry);
+        entry.width = width;
+        entry.height = height;
+    }
+}
+
+void FrameGraph::AddPass(const char* name, FrameStage stage, std::initializer_list<FrameResource> reads, std::initializer_list<FrameResource> writes,
+                         std::function<void()> execute, bool side_effect) {
+    m_passes.push_back({ name, stage, reads, writes, std::move(execute), side_effect, false });
+}
+
+void FrameGraph::Compile() {
+    for (Resource& resource : m_resources) {
+        resource.first_pass = -1;
+        resource.last_pass = -1;
+        resource.readers = 0;
+    }
+
+    // 由後往前：一個 pass 只有在它寫的 target 之後還有人讀（或有 side effect）才保留，保留下來的 pass 再替它讀的 target 計數
+    for (int i = static_cast<int>(m_passes.size()) - 1; i >= 0; i--) {
+        Pass& pass = m_passes[i];
+        pass.live = pass.side_effect || std::any_of(pass.writes.begin(), pass.writes.end(), [this](FrameResource resource) {
+            return m_resources[resource].readers > 0;
+        });
+        if (!pass.live) {
+            continue;
+        }
+        for (FrameResource resource : pass.reads) {
+            m_resources[resource].readers++;
+        }
+    }
+
+    // Lifetimes over the live passes
+    m_first_live_pass = -1;
+    for (int i = 0; i < static_cast<int>(m_passes.size()); i++) {
+        if (!m_passes[i].live) {
+            continue;
+        }
+        m_first_live_pass = m_first_live_pass < 0 ? i : m_first_live_pass;
+        for (const std::vector<FrameResource>* uses : { &m_passes[i].reads, &m_passes[i].writes }) {
+            for (FrameResource index : *uses) {
+                Resource& resource = m_resources[index];
+                resource.first_pass = resource.first_pass < 0 ? i : resource.first_pass;
+                resource.last_pass = i;
+            }
+        }
+    }
+}
+
+void FrameGraph::Execute(FrameStage stage) {
+    for (int i = 0; i < static_cast<int>(m_passes.size()); i++) {
+        Pass& pass = m_passes[i];
+        if (!pass.live || pass.stage != stage) {
+            continue;
+        }
+
+        // The whole graph runs again, the retained targets of the last run can be reused from here on
+        if (i == m_first_live_pass) {
+            for (Resource& resource : m_resources) {
+                if (resource.retained) {
+                    Release(resource);
+                }
+            }
+        }
+
+        // A target nobody reads is not created at all, the pass asks IsRealized() before drawing into it.
+        for (FrameResource index : pass.writes) {
+            Resource& resource = m_resources[index];
+            if (resource.imported == nullptr && resource.readers > 0 && resource.first_pass == i) {
+                Acquire(resource);
+            }
+        }
+
+        pass.execute();
+
+        // Back to the pool right after the last use, the next pass of the same bucket gets the same storage
+        for (const std::vector<FrameResource>* uses : { &pass.reads, &pass.writes }) {
+            for (FrameResource index : *uses) {
+                Resource& resource = m_resources[index];
+                if (!resource.retained && resource.last_pass == i) {
+                    Release(resource);
+                }
+            }
+        }
+    }
+}
+
+bool FrameGraph::IsRealized(FrameResource resource) const {
+    return m_resources[resource].imported != nullptr || m_resources[resource].target >= 0;
+}
+
+const RenderTarget& FrameGraph::Target(FrameResource resource) const {
+    const Resource& entry = m_resources[resource];
+    if (entry.imported != nullptr) {
+        return *entry.imported;
+    }
+    if (entry.target < 0) {
+        Logger::Message(LogLevel::Error, std::string("Frame graph resource is not realized: ") + entry.name);
+        exit(-1);
+    }
+    return RenderTargetPool::Shared().Target(entry.target);
+}
+
+TextureHandle FrameGraph::Texture(FrameResource resource) const {
+    return Target(resource).texture;
+}
+
+FrameBuffer& FrameGraph::Framebuffer(FrameResource resource) {
+    const Resource& entry = m_resources[resource];
+    if (entry.target < 0) {
+        Logger::Message(LogLevel::Error, std::string("Frame graph resource has no framebuffer: ") + entry.name);
+        exit(-1);
+    }
+    return RenderTargetPool::Shared().Framebuffer(entry.target);
+}
+
+int FrameGraph::PassCount() const {
+    return static_cast<int>(m_passes.size());
+}
+
+int FrameGraph::LivePassCount() const {
+    return static_cast<int>(std::count_if(m_passes.begin(), m_passes.end(), [](const Pass& pass) { return pass.live; }));
+}
+
+void FrameGraph::Acquire(Resource& resource) {
+    Release(resource);
+    resource.target = RenderTargetPool::Shared().Acquire(resource.width, resource.height);
+}
+
+void FrameGraph::Release(Resource& resource) {
+    if (resource.target >= 0) {
+        RenderTargetPool::Shared().Release(resource.target);
+        resource.target = -1;
+    }
+}
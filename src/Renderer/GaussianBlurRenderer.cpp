@@ -3,15 +3,17 @@
 #include <glad/glad.h>
 
 GaussianBlurRenderer::GaussianBlurRenderer(GaussianBlurShader* shader) : m_shader(shader) {
+    m_is_horizontal = m_shader->RegisterUniform("isHorizontal");
+    m_region = m_shader->RegisterUniform("region");
 }
 
 void GaussianBlurRenderer::Prepare(bool is_horizontal) {
     m_shader->Start();
-    m_shader->SetInt("image", 0);
-    m_shader->SetBool("isHorizontal", is_horizontal);
+    m_shader->SetBool(m_is_horizontal, is_horizontal);
 }
 
-void GaussianBlurRenderer::Render(const Texture2D* image, const Screen* screen) {
+void GaussianBlurRenderer::Render(const Texture2D* image, const glm::vec2& region, const Screen* screen) {
+    m_shader->SetVec2(m_region, region);
     image->Bind(GL_TEXTURE0);
     screen->Draw();
 }
\ No newline at end of file
@@ -1,6 +1,11 @@
 #include "Renderer/MasterRenderer.hpp"
 
+#include <chrono>
+
+#include "Shader/ShaderCache.hpp"
 #include "Texture/TextureManager.hpp"
+#include "Utility/Logger.hpp"
+#include "Utility/Profiler.hpp"
 
 MasterRenderer::MasterRenderer() {
     // Game Class 初始化的時候就會執行
@@ -10,12 +15,16 @@ MasterRenderer::MasterRenderer() {
     screen_shader = std::make_unique<ScreenShader>();
     gaussian_blur_shader = std::make_unique<GaussianBlurShader>();
     volume_shader = std::make_unique<VolumeShader>();
+    bloom_shader = std::make_unique<BloomShader>();
 
     // 建立 Renderer
     axes_renderer = std::make_unique<AxesRenderer>(basic_shader.get());
     screen_renderer = std::make_unique<ScreenRenderer>(screen_shader.get());
     gaussian_blur_renderer = std::make_unique<GaussianBlurRenderer>(gaussian_blur_shader.get());
     volume_renderer = std::make_unique<VolumeRenderer>(volume_shader.get());
+    bloom_renderer = std::make_unique<BloomRenderer>(bloom_shader.get());
+
+    frame_uniform_buffer = std::make_unique<UniformBuffer>(sizeof(FrameUniforms), FrameUniforms::Binding);
 
     // 設定 gl
     glEnable(GL_MULTISAMPLE);
@@ -24,6 +33,23 @@ MasterRenderer::MasterRenderer() {
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 }
 
+void MasterRenderer::WarmUp() {
+    const auto start = std::chrono::steady_clock::now();
+    const int hits = ShaderCache::Hits(), misses = ShaderCache::Misses();
+
+    basic_shader->SelectVariant({});
+    gaussian_blur_shader->SelectVariant({});
+    volume_renderer->SelectVariant(state.world->volume_texture_layout);
+    screen_renderer->SelectVariant();
+    bloom_renderer->WarmUp();
+
+    const std::chrono::duration<double, std::milli> cost = std::chrono::steady_clock::now() - start;
+    const int cached = ShaderCache::Hits() - hits, compiled = ShaderCache::Misses() - misses;
+    const std::string cache = !ShaderCache::IsEnabled() ? "disabled" : (compiled == 0 ? "warm" : (cached == 0 ? "cold" : "partly warm"));
+    Logger::Message(LogLevel::Info, "Shaders ready in " + std::to_string(cost.count()) + " ms, "
+                                    + std::to_string(cached) + " from the binary cache, " + std::to_string(compiled) + " compiled (" + cache + " cache)");
+}
+
 void MasterRenderer::Initialize() {
     // 在每一次的 Game loop 都會執行，且在分割畫面之前
 
@@ -41,16 +67,36 @@ void MasterRenderer::Initialize() {
     glEnable(GL_DEPTH_TEST);
 }
 
+void MasterRenderer::PrepareFrame(const std::unique_ptr<Camera>& camera) {
+    frame_uniforms.view = camera->View();
+    frame_uniforms.projection = camera->Projection();
+    frame_uniforms.view_position = camera->position;
+    frame_uniforms.bloom_threshold = state.world->bloom_threshold;
+    frame_uniforms.light_position = state.world->my_point_light->entity.position;
+    frame_uniforms.light_color = state.world->my_point_light->color;
+    frame_uniform_buffer->Update(&frame_uniforms);
+}
+
 void MasterRenderer::Render(const std::unique_ptr<Camera>& camera) {
     // Viewport settings
     camera->SetViewPort();
 
+    RenderVolume(camera);
+    RenderAxes(camera);
+}
+
+void MasterRenderer::RenderVolume(const std::unique_ptr<Camera>& camera) {
+    ProfileScope scope("Volume");
     // 繪製 Volume
     if (state.world->my_volume) {
+        volume_renderer->SelectVariant(state.world->my_volume->m_layout);
         volume_renderer->Prepare(camera);
         volume_renderer->Render(state.world->my_volume.get());
     }
+}
 
+void MasterRenderer::RenderAxes(const std::unique_ptr<Camera>& camera) {
+    ProfileScope scope("Axes");
     glDisable(GL_DEPTH_TEST);
     // 繪製 xyz 三軸
     if (state.world->draw_axes) {
@@ -66,23 +112,32 @@ void MasterRenderer::Destroy() {
     screen_shader->Destroy();
     gaussian_blur_shader->Destroy();
     volume_shader->Destroy();
+    bloom_shader->Destroy();
 }
 
-void MasterRenderer::GaussianBlur(bool is_horizontal, bool first_iteration) {
+void MasterRenderer::GaussianBlur(bool is_horizontal, const RenderTarget& source) {
     gaussian_blur_renderer->Prepare(is_horizontal);
-    if (first_iteration) {
-        gaussian_blur_renderer->Render(&TextureManager::GetTexture2D("Bloom"), state.world->my_screen.get());
-    } else {
-        gaussian_blur_renderer->Render(&TextureManager::GetTexture2D("GaussianBlur" + std::to_string(!is_horizontal)), state.world->my_screen.get());
-    }
+    gaussian_blur_renderer->Render(&TextureManager::GetTexture2D(source.texture), source.Region(), state.world->my_screen.get());
+}
+
+void MasterRenderer::BloomDownsample(const RenderTarget& source) {
+    bloom_renderer->Downsample(&TextureManager::GetTexture2D(source.texture), source.Region(), state.world->my_screen.get());
+}
+
+void MasterRenderer::BloomUpsample(const RenderTarget& source) {
+    bloom_renderer->Upsample(&TextureManager::GetTexture2D(source.texture), source.Region(), state.world->my_screen.get(),
+                             state.world->bloom_filter_radius);
 }
 
-void MasterRenderer::RenderScreen() {
+void MasterRenderer::RenderScreen(const RenderTarget& scene, const RenderTarget* bloom) {
     // Call By Application，在每一次 main loop 的結尾執行
+    ProfileScope scope("Screen");
     glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT);
     glDisable(GL_DEPTH_TEST);
 
-    screen_renderer->Prepare();
-    screen_renderer->Render(&TextureManager::GetTexture2D("PostProcessing"), &TextureManager::GetTexture2D("GaussianBlur0"), state.world->my_screen.get());
+    screen_renderer->Prepare(scene.width, scene.height);
+    screen_renderer->Render(&TextureManager::GetTexture2D(scene.texture), scene.Region(),
+                            bloom != nullptr ? &TextureManager::GetTexture2D(bloom->texture) : nullptr, bloom != nullptr ? bloom->Region() : glm::vec2(1.0f),
+                            state.world->my_screen.get());
 }
\ No newline at end of file
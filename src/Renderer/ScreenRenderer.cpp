@@ -1,32 +1,68 @@
 #include "Renderer/ScreenRenderer.hpp"
 
+#include "Renderer/BloomRenderer.hpp"
 #include "State.hpp"
 
 ScreenRenderer::ScreenRenderer(ScreenShader* shader) : m_shader(shader) {
+    m_bloom_intensity = m_shader->RegisterUniform("bloomIntensity");
+    m_gamma_value = m_shader->RegisterUniform("gammaValue");
+    m_hdr_exposure = m_shader->RegisterUniform("hdrExposure");
+    m_screen_region = m_shader->RegisterUniform("screenRegion");
+    m_bloom_region = m_shader->RegisterUniform("bloomRegion");
+}
+
+void ScreenRenderer::SelectVariant() {
+    const World* world = state.world.get();
+    const std::uint32_t key = static_cast<std::uint32_t>(world->current_screen_mode)
+                              | static_cast<std::uint32_t>(world->current_hdr_mode) << 8
+                              | static_cast<std::uint32_t>(world->use_bloom) << 16
+                              | static_cast<std::uint32_t>(world->use_hdr) << 17
+                              | static_cast<std::uint32_t>(world->use_gamma_correction) << 18;
 
+    auto it = m_variants.find(key);
+    if (it == m_variants.end()) {
+        m_defines.clear();
+        m_defines.push_back("SCREEN_MODE " + std::to_string(world->current_screen_mode));
+        if (world->use_bloom) m_defines.push_back("USE_BLOOM");
+        if (world->use_hdr) m_defines.push_back("USE_HDR");
+        if (world->use_hdr) m_defines.push_back("HDR_MODE " + std::to_string(world->current_hdr_mode));
+        if (world->use_gamma_correction) m_defines.push_back("USE_GAMMA");
+        it = m_variants.emplace(key, m_shader->GetVariant(m_defines)).first;
+    }
+    m_shader->UseVariant(it->second);
 }
 
-void ScreenRenderer::Prepare() {
+void ScreenRenderer::Prepare(int width, int height) {
+    SelectVariant();
+
+    const World* world = state.world.get();
     m_shader->Start();
-    m_shader->SetInt("screenTexture", 0);
-    m_shader->SetInt("screenMode", state.world->current_screen_mode);
 
-    m_shader->SetBool("useBloom", state.world->use_bloom);
-    if (state.world->use_bloom) {
-        m_shader->SetInt("bloomTexture", 1);
-        m_shader->SetFloat("bloomIntensity", state.world->bloom_intensity);
+    if (world->use_bloom) {
+        // The mip chain adds up every level, averaged here so the intensity does not depend on the depth.
+        const float bloom_scale = world->current_bloom_method == BloomMethod::MIP_CHAIN
+                                  ? 1.0f / static_cast<float>(BloomRenderer::ChainDepth(world->bloom_mip_levels, width, height))
+                                  : 1.0f;
+        m_shader->SetFloat(m_bloom_intensity, world->bloom_intensity * bloom_scale);
     }
 
-    m_shader->SetBool("useGamma", state.world->use_gamma_correction);
-    m_shader->SetFloat("gammaValue", state.world->gamma_value);
+    if (world->use_gamma_correction) {
+        m_shader->SetFloat(m_gamma_value, world->gamma_value);
+    }
 
-    m_shader->SetBool("useHDR", state.world->use_hdr);
-    m_shader->SetInt("hdrMode", state.world->current_hdr_mode);
-    m_shader->SetFloat("hdrExposure", state.world->hdr_exposure);
+    if (world->use_hdr && world->current_hdr_mode == HDRMode::EXPOSURE) {
+        m_shader->SetFloat(m_hdr_exposure, world->hdr_exposure);
+    }
 }
 
-void ScreenRenderer::Render(const Texture2D* screen_texture, const Texture2D* bloom_texture, const Screen* screen) {
+void ScreenRenderer::Render(const Texture2D* screen_texture, const glm::vec2& screen_region, const Texture2D* bloom_texture, const glm::vec2& bloom_region,
+                            const Screen* screen) {
+    m_shader->SetVec2(m_screen_region, screen_region);
     screen_texture->Bind(GL_TEXTURE0);
-    bloom_texture->Bind(GL_TEXTURE1);
+    // Without USE_BLOOM the shader has no bloom sampler
+    if (bloom_texture != nullptr) {
+        m_shader->SetVec2(m_bloom_region, bloom_region);
+        bloom_texture->Bind(GL_TEXTURE1);
+    }
     screen->Draw();
 }
\ No newline at end of file
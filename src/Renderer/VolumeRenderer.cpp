@@ -1,27 +1,52 @@
 #include "Renderer/VolumeRenderer.hpp"
 
 VolumeRenderer::VolumeRenderer(VolumeShader* shader) : m_shader(shader) {
+    m_uniform_buffer = std::make_unique<UniformBuffer>(sizeof(VolumeUniforms), VolumeUniforms::Binding);
+}
+
+void VolumeRenderer::SelectVariant(VolumeTextureLayout layout) {
+    const World* world = state.world.get();
+    // The reduced levels sample less often, their opacity is always corrected to the full quality step (see Prepare()).
+    const bool opacity_correction = world->use_opacity_correction || world->quality.Level() > 0;
+    const std::uint32_t key = static_cast<std::uint32_t>(layout)
+                              | static_cast<std::uint32_t>(world->use_lighting) << 2
+                              | static_cast<std::uint32_t>(world->use_normal_color) << 3
+                              | static_cast<std::uint32_t>(world->use_empty_space_skipping) << 4
+                              | static_cast<std::uint32_t>(world->use_preintegration) << 5
+                              | static_cast<std::uint32_t>(world->use_adaptive_sampling) << 6
+                              | static_cast<std::uint32_t>(opacity_correction) << 7
+                              | static_cast<std::uint32_t>(!world->use_slab_ray_setup) << 8;
 
+    auto it = m_variants.find(key);
+    if (it == m_variants.end()) {
+        m_defines.clear();
+        m_defines.push_back("VOLUME_LAYOUT " + std::to_string(static_cast<int>(layout)));
+        if (world->use_lighting) m_defines.push_back("USE_LIGHTING");
+        if (world->use_normal_color) m_defines.push_back("USE_NORMAL_COLOR");
+        if (world->use_empty_space_skipping) m_defines.push_back("USE_EMPTY_SPACE_SKIPPING");
+        if (world->use_preintegration) m_defines.push_back("USE_PREINTEGRATION");
+        if (world->use_adaptive_sampling) m_defines.push_back("USE_ADAPTIVE_SAMPLING");
+        if (opacity_correction) m_defines.push_back("USE_OPACITY_CORRECTION");
+        if (!world->use_slab_ray_setup) m_defines.push_back("USE_LEGACY_RAY_SETUP");
+        it = m_variants.emplace(key, m_shader->GetVariant(m_defines)).first;
+    }
+    m_shader->UseVariant(it->second);
 }
 
 void VolumeRenderer::Prepare(const std::unique_ptr<Camera>& camera) {
+    // The samplers are bound when the permutation is linked and the camera and the light are in FrameData.
     m_shader->Start();
-    m_shader->SetBool("useLighting", state.world->use_lighting);
-    m_shader->SetBool("useNormalColor", state.world->use_normal_color);
-    m_shader->SetInt("volume", 0);
-    m_shader->SetInt("transfer_function", 1);
-    m_shader->SetFloat("sample_rate", state.world->sample_rate);
-    m_shader->SetVec3("background_color", state.world->background_color);
-
-    m_shader->SetFloat("bloomThreshold", state.world->bloom_threshold);
-
-    // Load Lights
-    m_shader->SetPointLight(state.world->my_point_light);
-    m_shader->SetFloat("shininess", 256.0f);
-
-    // Load View and Projection Matrix
-    m_shader->SetViewAndProj(camera);
-    m_shader->SetVec3("viewPos", camera->position);
+    m_camera_position = camera->position;
+
+    // A permutation ignores the members it does not use, so they are written unconditionally.
+    m_uniforms.sample_rate = state.world->sample_rate * state.world->quality.StepScale();
+    m_uniforms.background_color = state.world->background_color;
+    m_uniforms.brick_size = static_cast<float>(BrickGrid::BrickSize);
+    m_uniforms.max_step_scale = state.world->adaptive_max_step_scale;
+    m_uniforms.importance_threshold = state.world->adaptive_importance_threshold;
+    // Without the correction of the settings the transfer function is taken at the full quality step, so the refined image does not change.
+    m_uniforms.reference_step = state.world->use_opacity_correction ? state.world->opacity_reference_step : state.world->sample_rate;
+    m_uniforms.shininess = 256.0f;
 }
 
 void VolumeRenderer::Render(const Volume* volume) {
@@ -33,24 +58,56 @@ void VolumeRenderer::Render(const Volume* volume) {
     // skybox.Active(GL_TEXTURE1);
     // skybox.Bind();
 
-    volume->m_texture.Active(GL_TEXTURE0);
-    volume->m_texture.Bind();
-    volume->m_transfer_texture.Active(GL_TEXTURE1);
-    volume->m_transfer_texture.Bind();
-
+    volume->m_texture->Active(GL_TEXTURE0);
+    volume->m_texture->Bind();
+    volume->m_transfer_texture->Active(GL_TEXTURE1);
+    volume->m_transfer_texture->Bind();
+    if (volume->m_normal_texture) {
+        volume->m_normal_texture->Active(GL_TEXTURE2);
+        volume->m_normal_texture->Bind();
+    }
+    if (volume->m_occupancy_texture) {
+        volume->m_occupancy_texture->Active(GL_TEXTURE3);
+        volume->m_occupancy_texture->Bind();
+    }
+    if (volume->m_importance_texture) {
+        volume->m_importance_texture->Active(GL_TEXTURE5);
+        volume->m_importance_texture->Bind();
+    }
+    if (volume->m_preintegration_texture) {
+        volume->m_preintegration_texture->Bind(GL_TEXTURE4);
+    }
+    m_uniforms.value_scale = volume->GetValueScale();
 
     // Prepare Material (Only Color)
-    m_shader->SetVec3("volume_resolution", volume->m_info.resolution.GetVec3());
-    m_shader->SetVec3("volume_ratio", volume->m_info.voxel_size);
+    m_uniforms.volume_resolution = volume->m_info.resolution.GetVec3();
+    m_uniforms.volume_ratio = volume->m_info.voxel_size;
 
     // Prepare Instance
     glm::vec3 resolution = glm::vec3(volume->m_info.resolution.x, volume->m_info.resolution.y, volume->m_info.resolution.z);
     glm::mat4 model_matrix = glm::mat4(1.0f);
     model_matrix = glm::translate(model_matrix, resolution * volume->m_info.voxel_size * -0.5f);
-    m_shader->SetMat4("model", model_matrix);
+    m_uniforms.model = model_matrix;
+
+    // The ray is set up against the box in texture space, [0, 1]^3 covers the whole model.
+    const glm::vec3 actual_resolution = resolution * volume->m_info.voxel_size;
+    m_uniforms.camera_in_texture = (m_camera_position + actual_resolution * 0.5f) / actual_resolution;
+    m_uniform_buffer->Update(&m_uniforms);
 
-    // Draw
-    volume->DrawOnly();
+    // Draw the back faces only: every pixel covered by the volume gets exactly one fragment,
+    // also when the camera is inside the volume and the front faces are behind it.
+    // The legacy setup starts at the fragment, so it draws the front faces (with the culling of the settings) like before.
+    if (state.world->use_slab_ray_setup) {
+        glEnable(GL_CULL_FACE);
+        glCullFace(GL_FRONT);
+        volume->DrawOnly();
+        glCullFace(GL_BACK);
+        if (!state.world->culling) {
+            glDisable(GL_CULL_FACE);
+        }
+    } else {
+        volume->DrawOnly();
+    }
 
     // Unbind VAO and Texture
     volume->UnBind();
@@ -0,0 +1,8 @@
+#include "Shader/BloomShader.hpp"
+
+const std::string BloomShader::VERTEX_FILE = "assets/shaders/bloom.vert";
+const std::string BloomShader::FRAGMENT_FILE = "assets/shaders/bloom.frag";
+
+BloomShader::BloomShader() : Shader(VERTEX_FILE, FRAGMENT_FILE) {
+    BindSampler("source", 0);
+}
\ No newline at end of file
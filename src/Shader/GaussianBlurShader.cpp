@@ -3,4 +3,6 @@
 const std::string GaussianBlurShader::VERTEX_FILE = "assets/shaders/gaussianblur.vert";
 const std::string GaussianBlurShader::FRAGMENT_FILE = "assets/shaders/gaussianblur.frag";
 
-GaussianBlurShader::GaussianBlurShader() : Shader(VERTEX_FILE, FRAGMENT_FILE) {}
\ No newline at end of file
+GaussianBlurShader::GaussianBlurShader() : Shader(VERTEX_FILE, FRAGMENT_FILE) {
+    BindSampler("image", 0);
+}
\ No newline at end of file
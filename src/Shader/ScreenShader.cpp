@@ -3,4 +3,7 @@
 const std::string ScreenShader::VERTEX_FILE = "assets/shaders/screen.vert";
 const std::string ScreenShader::FRAGMENT_FILE = "assets/shaders/screen.frag";
 
-ScreenShader::ScreenShader() : Shader(VERTEX_FILE, FRAGMENT_FILE) {}
\ No newline at end of file
+ScreenShader::ScreenShader() : Shader(VERTEX_FILE, FRAGMENT_FILE) {
+    BindSampler("screenTexture", 0);
+    BindSampler("bloomTexture", 1);
+}
\ No newline at end of file
@@ -1,35 +1,69 @@
 #include "Shader/Shader.hpp"
 
+#include <chrono>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
 
-Shader::Shader(const std::string& vertex_path, const std::string& fragment_path, const std::string& geometry_path) {
-    vertex_id = CreateShader(vertex_path, ShaderType::Vert);
-    fragment_id = CreateShader(fragment_path, ShaderType::Frag);
-    geometry_id = (!geometry_path.empty())? CreateShader(geometry_path, ShaderType::Geom) : 0;
+#include "Shader/ShaderCache.hpp"
+#include "Utility/Logger.hpp"
 
-    id = glCreateProgram();
-    glAttachShader(id, vertex_id);
-    glAttachShader(id, fragment_id);
-    if (geometry_id) {
-        glAttachShader(id, geometry_id);
+Shader::Shader(const std::string& vertex_path, const std::string& fragment_path, const std::string& geometry_path)
+    : m_vertex_path(vertex_path), m_fragment_path(fragment_path), m_geometry_path(geometry_path) {
+    m_vertex_source = ReadSource(vertex_path);
+    m_fragment_source = ReadSource(fragment_path);
+    m_geometry_source = (!geometry_path.empty())? ReadSource(geometry_path) : "";
+}
+
+VariantHandle Shader::GetVariant(const ShaderDefines& defines) {
+    m_key.clear();
+    for (const auto& define : defines) {
+        m_key += define;
+        m_key += '\n';
     }
-    glLinkProgram(id);
-    glValidateProgram(id);
 
-    if (LinkShaderProgram() != GL_TRUE) {
-        GLint len;
-        std::string log;
-        glGetProgramiv(id, GL_INFO_LOG_LENGTH, &len);
-        log.resize(len);
-        glGetProgramInfoLog(id, len, nullptr, log.data());
-        std::cerr << "[Error] " << log << std::endl;
+    auto it = m_variant_handles.find(m_key);
+    if (it != m_variant_handles.end()) {
+        return it->second;
+    }
+
+    Variant variant = CreateVariant(defines);
+    if (variant.id) {
+        m_variants.push_back(std::move(variant));
+        BindResources(m_variants.back());
+        return m_variant_handles.emplace(m_key, static_cast<VariantHandle>(m_variants.size() - 1)).first->second;
+    }
+
+    // A permutation compiled while running must not end the application: use the last good one, or the one without defines.
+    // The failed key maps to the fallback, so it is not compiled again every frame.
+    if (defines.empty()) {
+        Logger::Message(LogLevel::Error, "The base permutation of " + m_fragment_path + " does not compile, there is nothing to fall back to");
         exit(-1);
     }
+    const std::string key = m_key;
+    Logger::Message(LogLevel::Error, "Permutation [" + VariantName(defines) + "] of " + m_fragment_path + " failed, falling back to the "
+                                     + (m_current >= 0 ? "current" : "base") + " permutation");
+    const VariantHandle fallback = (m_current >= 0) ? m_current : GetVariant({});
+    return m_variant_handles.emplace(key, fallback).first->second;
 }
 
-void Shader::Start() const {
+void Shader::UseVariant(VariantHandle variant) {
+    m_current = variant;
+    id = m_variants[variant].id;
+}
+
+void Shader::SelectVariant(const ShaderDefines& defines) {
+    UseVariant(GetVariant(defines));
+}
+
+std::size_t Shader::GetVariantCount() const {
+    return m_variants.size();
+}
+
+void Shader::Start() {
+    if (m_current < 0) {
+        SelectVariant({});
+    }
     glUseProgram(id);
 }
 
@@ -39,18 +73,25 @@ void Shader::Stop() const {
 
 void Shader::Destroy() const {
     Stop();
-    glDetachShader(id, vertex_id);
-    glDeleteShader(vertex_id);
+    for (const auto& variant : m_variants) {
+        // A program from the binary cache has no shader objects.
+        if (variant.vertex_id) {
+            glDetachShader(variant.id, variant.vertex_id);
+            glDeleteShader(variant.vertex_id);
+        }
 
-    glDetachShader(id, fragment_id);
-    glDeleteShader(fragment_id);
+        if (variant.fragment_id) {
+            glDetachShader(variant.id, variant.fragment_id);
+            glDeleteShader(variant.fragment_id);
+        }
 
-    if (geometry_id) {
-        glDetachShader(id, geometry_id);
-        glDeleteShader(geometry_id);
-    }
+        if (variant.geometry_id) {
+            glDetachShader(variant.id, variant.geometry_id);
+            glDeleteShader(variant.geometry_id);
+        }
 
-    glDeleteProgram(id);
+        glDeleteProgram(variant.id);
+    }
 }
 
 void Shader::SetInt(const std::string& uniform_name, int value) {
@@ -83,15 +124,60 @@ void Shader::SetMat4(const std::string& uniform_name, const glm::mat4& matrix) {
     glUniformMatrix4fv(GetUniformLocation(uniform_name), 1, GL_FALSE, glm::value_ptr(matrix));
 }
 
-void Shader::SetViewAndProj(const std::unique_ptr<Camera>& camera) {
-    glm::mat4 view = camera->View();
-    glm::mat4 projection = camera->Projection();
+UniformHandle Shader::RegisterUniform(const std::string& uniform_name) {
+    for (std::size_t i = 0; i < m_uniform_names.size(); i++) {
+        if (m_uniform_names[i] == uniform_name) {
+            return static_cast<UniformHandle>(i);
+        }
+    }
+
+    m_uniform_names.push_back(uniform_name);
+    for (auto& variant : m_variants) {
+        variant.locations.push_back(glGetUniformLocation(variant.id, uniform_name.c_str()));
+    }
+    return static_cast<UniformHandle>(m_uniform_names.size() - 1);
+}
+
+void Shader::BindSampler(const std::string& sampler_name, int texture_unit) {
+    m_samplers.emplace_back(sampler_name, texture_unit);
+    for (auto& variant : m_variants) {
+        BindResources(variant);
+    }
+}
+
+void Shader::BindUniformBlock(const std::string& block_name, GLuint binding) {
+    m_uniform_blocks.emplace_back(block_name, binding);
+    for (auto& variant : m_variants) {
+        BindResources(variant);
+    }
+}
+
+void Shader::SetInt(UniformHandle uniform, int value) {
+    glUniform1i(m_variants[m_current].locations[uniform], value);
+}
+
+void Shader::SetBool(UniformHandle uniform, bool value) {
+    glUniform1i(m_variants[m_current].locations[uniform], value);
+}
+
+void Shader::SetFloat(UniformHandle uniform, float value) {
+    glUniform1f(m_variants[m_current].locations[uniform], value);
+}
+
+void Shader::SetVec2(UniformHandle uniform, const glm::vec2& vector) {
+    glUniform2fv(m_variants[m_current].locations[uniform], 1, glm::value_ptr(vector));
+}
+
+void Shader::SetVec3(UniformHandle uniform, const glm::vec3& vector) {
+    glUniform3fv(m_variants[m_current].locations[uniform], 1, glm::value_ptr(vector));
+}
 
-    SetMat4("view", view);
-    SetMat4("projection", projection);
+void Shader::SetMat4(UniformHandle uniform, const glm::mat4& matrix) {
+    glUniformMatrix4fv(m_variants[m_current].locations[uniform], 1, GL_FALSE, glm::value_ptr(matrix));
 }
 
 GLint Shader::GetUniformLocation(const std::string& uniform_name) {
+    std::unordered_map<std::string, GLint>& uniform_location_cache = m_variants[m_current].uniform_location_cache;
     if (uniform_location_cache.find(uniform_name) != uniform_location_cache.end()) {
         return uniform_location_cache[uniform_name];
     }
@@ -106,7 +192,7 @@ GLint Shader::GetUniformLocation(const std::string& uniform_name) {
     return location;
 }
 
-GLuint Shader::CreateShader(const std::string& shader_filepath, ShaderType shader_type) {
+std::string Shader::ReadSource(const std::string& shader_filepath) {
     std::ifstream file;
     std::string source;
 
@@ -119,6 +205,129 @@ GLuint Shader::CreateShader(const std::string& shader_filepath, ShaderType shade
     file.read(source.data(), source.size());
     file.close();
 
+    return source;
+}
+
+std::string Shader::InsertDefines(const std::string& source, const ShaderDefines& defines) {
+    if (defines.empty()) {
+        return source;
+    }
+
+    // #version has to stay the first line, the defines go right after it.
+    const std::size_t version = source.find("#version");
+    const std::size_t line_end = version == std::string::npos ? std::string::npos : source.find('\n', version);
+    const std::size_t insert_at = line_end == std::string::npos ? 0 : line_end + 1;
+
+    std::string result = source.substr(0, insert_at);
+    for (const auto& define : defines) {
+        result += "#define " + define + "\n";
+    }
+    // Keep the line numbers of the compile errors the same as in the file.
+    result += "#line " + std::to_string(insert_at == 0 ? 1 : 2) + "\n";
+    result += source.substr(insert_at);
+    return result;
+}
+
+Shader::Variant Shader::CreateVariant(const ShaderDefines& defines) {
+    auto start = std::chrono::steady_clock::now();
+
+    const std::string name = VariantName(defines);
+
+    const std::string vertex_source = InsertDefines(m_vertex_source, defines);
+    const std::string fragment_source = InsertDefines(m_fragment_source, defines);
+    const std::string geometry_source = (!m_geometry_path.empty())? InsertDefines(m_geometry_source, defines) : "";
+    const std::uint64_t cache_key = ShaderCache::Key({ vertex_source, fragment_source, geometry_source });
+
+    Variant variant;
+    variant.id = ShaderCache::Load(cache_key);
+    if (variant.id) {
+        std::chrono::duration<double, std::milli> cost = std::chrono::steady_clock::now() - start;
+        Logger::Message(LogLevel::Info, "Loaded " + m_fragment_path + " [" + name + "] from the binary cache in " + std::to_string(cost.count()) + " ms");
+        return variant;
+    }
+
+    variant.vertex_id = CreateShader(vertex_source, m_vertex_path, ShaderType::Vert);
+    variant.fragment_id = CreateShader(fragment_source, m_fragment_path, ShaderType::Frag);
+    variant.geometry_id = (!m_geometry_path.empty())? CreateShader(geometry_source, m_geometry_path, ShaderType::Geom) : 0;
+    if (!variant.vertex_id || !variant.fragment_id || (!m_geometry_path.empty() && !variant.geometry_id)) {
+        DeleteVariant(variant);
+        return Variant();
+    }
+
+    variant.id = glCreateProgram();
+    if (ShaderCache::IsEnabled()) {
+        glProgramParameteri(variant.id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+    glAttachShader(variant.id, variant.vertex_id);
+    glAttachShader(variant.id, variant.fragment_id);
+    if (variant.geometry_id) {
+        glAttachShader(variant.id, variant.geometry_id);
+    }
+    glLinkProgram(variant.id);
+    glValidateProgram(variant.id);
+
+    // Querying the link status waits for the driver, so the time covers the whole compilation.
+    if (LinkShaderProgram(variant.id) != GL_TRUE) {
+        GLint len;
+        std::string log;
+        glGetProgramiv(variant.id, GL_INFO_LOG_LENGTH, &len);
+        log.resize(len);
+        glGetProgramInfoLog(variant.id, len, nullptr, log.data());
+        std::cerr << "[Error] " << log << std::endl;
+        DeleteVariant(variant);
+        return Variant();
+    }
+    std::chrono::duration<double, std::milli> cost = std::chrono::steady_clock::now() - start;
+    ShaderCache::Store(cache_key, variant.id);
+
+    Logger::Message(LogLevel::Info, "Compiled " + m_fragment_path + " [" + name + "] in " + std::to_string(cost.count()) + " ms");
+
+    return variant;
+}
+
+std::string Shader::VariantName(const ShaderDefines& defines) {
+    std::string name;
+    for (const auto& define : defines) {
+        name += (name.empty() ? "" : ", ") + define;
+    }
+    return name;
+}
+
+void Shader::DeleteVariant(const Variant& variant) {
+    // glDelete* ignore 0
+    glDeleteProgram(variant.id);
+    glDeleteShader(variant.vertex_id);
+    glDeleteShader(variant.fragment_id);
+    glDeleteShader(variant.geometry_id);
+}
+
+void Shader::BindResources(Variant& variant) const {
+    variant.locations.clear();
+    for (const auto& uniform_name : m_uniform_names) {
+        variant.locations.push_back(glGetUniformLocation(variant.id, uniform_name.c_str()));
+    }
+
+    // The sampler units are uniforms of the program, which has to be current to set them (no glProgramUniform in 3.3).
+    GLint previous_program = 0;
+    glGetIntegerv(GL_CURRENT_PROGRAM, &previous_program);
+    glUseProgram(variant.id);
+    for (const auto& [sampler_name, texture_unit] : m_samplers) {
+        const GLint location = glGetUniformLocation(variant.id, sampler_name.c_str());
+        if (location != -1) {
+            glUniform1i(location, texture_unit);
+        }
+    }
+    glUseProgram(previous_program);
+
+    for (const auto& [block_name, binding] : m_uniform_blocks) {
+        const GLuint block_index = glGetUniformBlockIndex(variant.id, block_name.c_str());
+        if (block_index != GL_INVALID_INDEX) {
+            glUniformBlockBinding(variant.id, block_index, binding);
+        }
+    }
+}
+
+GLuint Shader::CreateShader(const std::string& source, const std::string& shader_filepath, ShaderType shader_type) {
     const char* ShaderCode = source.c_str();
 
     // Compile these shaders.
@@ -133,7 +342,8 @@ GLuint Shader::CreateShader(const std::string& shader_filepath, ShaderType shade
         log.resize(len);
         glGetShaderInfoLog(shader_obj, len, nullptr, log.data());
         std::cerr << "[Error] On: " << shader_filepath << ": " << log << std::endl;
-        exit(-2);
+        glDeleteShader(shader_obj);
+        return 0;
     }
 
     return shader_obj;
@@ -145,8 +355,8 @@ GLboolean Shader::CompileShader(const GLuint& shader_id) {
     return status;
 }
 
-GLboolean Shader::LinkShaderProgram() {
+GLboolean Shader::LinkShaderProgram(const GLuint& program_id) {
     GLint status;
-    glGetProgramiv(id, GL_LINK_STATUS, &status);
+    glGetProgramiv(program_id, GL_LINK_STATUS, &status);
     return status;
 }
\ No newline at end of file
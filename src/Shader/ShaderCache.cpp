@@ -0,0 +1,180 @@
+#include "Shader/ShaderCache.hpp"
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+
+#include "Utility/Logger.hpp"
+
+namespace {
+    // Bumped when the layout of the files changes.
+    constexpr std::uint32_t FileMagic = 0x42505256; // "VRPB"
+    constexpr std::uint32_t FileVersion = 1;
+
+    struct FileHeader {
+        std::uint32_t magic;
+        std::uint32_t version;
+        std::uint64_t key;
+        std::uint32_t binary_format;
+        std::uint32_t length;
+    };
+
+    std::string cache_directory;
+    std::string driver_string;
+    bool is_enabled = false;
+    int hits = 0;
+    int misses = 0;
+
+    // FNV-1a
+    std::uint64_t Hash(std::uint64_t hash, const std::string& text) {
+        for (const unsigned char c : text) {
+            hash ^= c;
+            hash *= 0x100000001b3ULL;
+        }
+        return hash;
+    }
+
+    std::string GLString(GLenum name) {
+        const GLubyte* value = glGetString(name);
+        return value ? reinterpret_cast<const char*>(value) : "";
+    }
+}
+
+void ShaderCache::Initialize(const std::string& directory) {
+    is_enabled = false;
+    if (directory.empty()) {
+        Logger::Message(LogLevel::Info, "Shader binary cache: disabled");
+        return;
+    }
+
+    // glad leaves the entry points null when neither GL 4.1 nor ARB_get_program_binary is there.
+    GLint format_count = 0;
+    if (glGetProgramBinary != nullptr && glProgramBinary != nullptr && glProgramParameteri != nullptr) {
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &format_count);
+    }
+    if (format_count <= 0) {
+        Logger::Message(LogLevel::Warning, "Shader binary cache: the driver has no program binary format, shaders are always compiled");
+        return;
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    if (error) {
+        Logger::Message(LogLevel::Warning, "Shader binary cache: can not create " + directory + ": " + error.message());
+        return;
+    }
+
+    cache_directory = directory;
+    driver_string = GLString(GL_VENDOR) + "\n" + GLString(GL_RENDERER) + "\n" + GLString(GL_VERSION);
+    is_enabled = true;
+    Logger::Message(LogLevel::Info, "Shader binary cache: " + directory);
+}
+
+bool ShaderCache::IsEnabled() {
+    return is_enabled;
+}
+
+std::uint64_t ShaderCache::Key(const std::vector<std::string>& sources) {
+    std::uint64_t hash = Hash(0xcbf29ce484222325ULL, driver_string);
+    for (const auto& source : sources) {
+        // The length separates the stages, "ab" + "c" and "a" + "bc" differ.
+        hash = Hash(hash, std::to_string(source.size()));
+        hash = Hash(hash, source);
+    }
+    return hash;
+}
+
+GLuint ShaderCache::Load(std::uint64_t key) {
+    if (!is_enabled) {
+        return 0;
+    }
+
+    const std::string file_path = FilePath(key);
+    std::ifstream file(file_path, std::ios::binary);
+    if (file.fail()) {
+        misses++;
+        return 0;
+    }
+
+    // The length in the header has to match the rest of the file, a corrupted one must not size the buffer.
+    std::error_code size_error;
+    const std::uintmax_t file_size = std::filesystem::file_size(file_path, size_error);
+    FileHeader header {};
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    std::vector<char> binary;
+    if (file && !size_error && header.magic == FileMagic && header.version == FileVersion && header.key == key
+        && header.length > 0 && file_size >= sizeof(header) && header.length == file_size - sizeof(header)) {
+        binary.resize(header.length);
+        file.read(binary.data(), static_cast<std::streamsize>(binary.size()));
+    }
+    file.close();
+
+    GLint status = GL_FALSE;
+    GLuint program = 0;
+    if (!binary.empty() && file) {
+        program = glCreateProgram();
+        glProgramBinary(program, header.binary_format, binary.data(), static_cast<GLsizei>(binary.size()));
+        glGetProgramiv(program, GL_LINK_STATUS, &status);
+    }
+
+    if (status != GL_TRUE) {
+        // Truncated, from another build or rejected by the driver: compile it again and overwrite the file.
+        if (program) {
+            glDeleteProgram(program);
+        }
+        Logger::Message(LogLevel::Warning, "Shader binary cache: " + file_path + " is not usable, compiling from source");
+        std::error_code error;
+        std::filesystem::remove(file_path, error);
+        misses++;
+        return 0;
+    }
+
+    hits++;
+    return program;
+}
+
+void ShaderCache::Store(std::uint64_t key, GLuint program) {
+    if (!is_enabled) {
+        return;
+    }
+
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) {
+        return;
+    }
+
+    std::vector<char> binary(length);
+    GLenum binary_format = 0;
+    glGetProgramBinary(program, length, nullptr, &binary_format, binary.data());
+
+    // Written to a temporary file first, a crash in between never leaves a truncated binary behind.
+    const std::string file_path = FilePath(key);
+    const std::string temporary_path = file_path + ".tmp";
+    std::ofstream file(temporary_path, std::ios::binary);
+    const FileHeader header { FileMagic, FileVersion, key, binary_format, static_cast<std::uint32_t>(length) };
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(binary.data(), static_cast<std::streamsize>(binary.size()));
+    file.close();
+    if (file.fail()) {
+        Logger::Message(LogLevel::Warning, "Shader binary cache: failed to write " + file_path);
+        return;
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temporary_path, file_path, error);
+}
+
+int ShaderCache::Hits() {
+    return hits;
+}
+
+int ShaderCache::Misses() {
+    return misses;
+}
+
+std::string ShaderCache::FilePath(std::uint64_t key) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(key));
+    return (std::filesystem::path(cache_directory) / name).string();
+}
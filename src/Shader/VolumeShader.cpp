@@ -1,11 +1,19 @@
 #include "Shader/VolumeShader.hpp"
 
+#include "Shader/UniformBlocks.hpp"
+
 const std::string VolumeShader::VERTEX_FILE = "assets/shaders/volume.vert";
 const std::string VolumeShader::FRAGMENT_FILE = "assets/shaders/volume.frag";
 
-VolumeShader::VolumeShader() : Shader(VERTEX_FILE, FRAGMENT_FILE) {}
+VolumeShader::VolumeShader() : Shader(VERTEX_FILE, FRAGMENT_FILE) {
+    // The texture units of Volume, see VolumeRenderer::Render()
+    BindSampler("volume", 0);
+    BindSampler("transfer_function", 1);
+    BindSampler("normal_volume", 2);
+    BindSampler("occupancy", 3);
+    BindSampler("preintegration_table", 4);
+    BindSampler("brick_importance", 5);
 
-void VolumeShader::SetPointLight(const std::unique_ptr<Light>& point_light) {
-    SetVec3("light.position", point_light->entity.position);
-    SetVec3("light.color", point_light->color);
+    BindUniformBlock("FrameData", FrameUniforms::Binding);
+    BindUniformBlock("VolumeData", VolumeUniforms::Binding);
 }
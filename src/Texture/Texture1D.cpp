@@ -1,6 +1,6 @@
 #include "Texture/Texture1D.hpp"
 
-Texture1D::Texture1D() : m_id(0) {
+Texture1D::Texture1D() : m_id(0), m_width(0) {
     glGenTextures(1, &m_id);
 }
 
@@ -36,8 +36,15 @@ void Texture1D::SetFilterParameters(GLint min_filter, GLint mag_filter) const {
 void Texture1D::Generate(GLint internal_format, GLenum format, int image_width, const float* data) {
     Bind();
     glTexImage1D(GL_TEXTURE_1D, 0, internal_format, image_width, 0, format, GL_FLOAT, data);
+    m_width = image_width;
 
     SetWrapParameters(GL_CLAMP_TO_EDGE);
     SetFilterParameters(GL_LINEAR, GL_LINEAR);
     UnBind();
 }
+
+void Texture1D::Update(GLenum format, int offset, int width, const float* data) const {
+    Bind();
+    glTexSubImage1D(GL_TEXTURE_1D, 0, offset, width, format, GL_FLOAT, data);
+    UnBind();
+}
@@ -47,4 +47,21 @@ void Texture2D::Generate(GLint internal_format, GLenum format, int image_width,i
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     // glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 1);
     UnBind();
-}
\ No newline at end of file
+}
+
+void Texture2D::Generate(GLint internal_format, GLenum format, int image_width, int image_height, const float* data) {
+    Bind();
+    glTexImage2D(GL_TEXTURE_2D, 0, internal_format, image_width, image_height, 0, format, GL_FLOAT, data);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    UnBind();
+}
+
+void Texture2D::Update(GLenum format, int image_width, int image_height, const float* data) const {
+    Bind();
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, image_width, image_height, format, GL_FLOAT, data);
+    UnBind();
+}
@@ -35,13 +35,23 @@ void Texture3D::SetFilterParameters(GLint min_filter, GLint mag_filter) const {
     UnBind();
 }
 
-void Texture3D::Generate(GLint internal_format, GLenum format, int width, int height, int depth, const float* data) {
-    // Notice that the data type of the image data, we set GL_FLOAT here for the volume rendering.
+void Texture3D::Generate(GLint internal_format, GLenum format, GLenum type, int width, int height, int depth, const void* data) {
+    // The pixel type follows the data (e.g. GL_UNSIGNED_BYTE for R8 voxels, GL_FLOAT for RGBA32F texels).
     Bind();
-    // glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-    glTexImage3D(GL_TEXTURE_3D, 0, internal_format, width, height, depth, 0, format, GL_FLOAT, data);
+    // Rows of 1-, 2- and 3-byte texels are tightly packed, they are not padded to 4 bytes.
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage3D(GL_TEXTURE_3D, 0, internal_format, width, height, depth, 0, format, type, data);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
 
     SetWrapParameters(GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE);
     SetFilterParameters(GL_LINEAR, GL_LINEAR);
     UnBind();
 }
+
+void Texture3D::Update(GLenum format, GLenum type, int width, int height, int depth, const void* data) const {
+    Bind();
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage3D(GL_TEXTURE_3D, 0, 0, 0, 0, width, height, depth, format, type, data);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    UnBind();
+}
@@ -2,74 +2,194 @@
 
 #include <stb_image.h>
 
+#include <algorithm>
 #include <utility>
 
-#include "State.hpp"
 #include "Utility/Logger.hpp"
 
-std::map<std::string, Texture2D> TextureManager::texture2Ds;
-std::map<std::string, CubeMap> TextureManager::cubemaps;
+ResourceRegistry<Texture2D> TextureManager::texture2Ds;
+ResourceRegistry<CubeMap> TextureManager::cubemaps;
+
+namespace {
+    std::size_t BytesPerTexel(GLint internal_format) {
+        switch (internal_format) {
+            case GL_R8:
+                return 1;
+            case GL_RGB8:
+            case GL_SRGB8:
+                return 3;
+            case GL_RGBA8:
+            case GL_SRGB_ALPHA:
+                return 4;
+            case GL_RGB16F:
+                return 6;
+            default:
+                return 4;
+        }
+    }
+
+    // One level, or the whole chain down to 1x1
+    std::size_t ImageBytes(int width, int height, GLint internal_format, bool mipmapped) {
+        std::size_t bytes = 0;
+        while (true) {
+            bytes += static_cast<std::size_t>(width) * static_cast<std::size_t>(height) * BytesPerTexel(internal_format);
+            if (!mipmapped || (width == 1 && height == 1)) {
+                return bytes;
+            }
+            width = std::max(width / 2, 1);
+            height = std::max(height / 2, 1);
+        }
+    }
+}
 
 void TextureManager::Initialize() {
-    // Create Texture for Post Processing
-    TextureManager::CreateTexture2D(state.window->width, state.window->height, "PostProcessing");
-    TextureManager::CreateTexture2D(state.window->width, state.window->height, "Bloom");
-    TextureManager::CreateTexture2D(state.window->width, state.window->height, "GaussianBlur0");
-    TextureManager::CreateTexture2D(state.window->width, state.window->height, "GaussianBlur1");
+    // The render targets are not created here, Game sizes them with its RenderTargetPool.
+    // Image textures and cube maps of the scene are loaded here (CreateTexture2D(), CreateCubeMap()).
 }
 
 void TextureManager::Destroy() {
-    for (auto &iteration : texture2Ds) {
-        iteration.second.Destroy();
+    for (std::size_t i = 0; i < texture2Ds.resources.size(); i++) {
+        if (texture2Ds.infos[i].alive) {
+            Release(TextureHandle { static_cast<std::uint32_t>(i), texture2Ds.infos[i].generation });
+        }
     }
 
-    for (auto &iteration : cubemaps) {
-        iteration.second.Destroy();
+    for (std::size_t i = 0; i < cubemaps.resources.size(); i++) {
+        if (cubemaps.infos[i].alive) {
+            Release(CubeMapHandle { static_cast<std::uint32_t>(i), cubemaps.infos[i].generation });
+        }
     }
 }
 
-Texture2D &TextureManager::CreateTexture2D(const std::string &file_name, const std::string &texture_name, bool is_srgb, bool is_flip) {
+TextureHandle TextureManager::CreateTexture2D(const std::string &file_name, const std::string &texture_name, bool is_srgb, bool is_flip) {
     std::string file_path = "assets/textures/" + file_name;
-    texture2Ds[texture_name] = LoadTexture2DFromFile(file_path, is_srgb, is_flip);
-    return texture2Ds[texture_name];
+    TextureInfo info;
+    info.name = texture_name;
+    info.kind = TextureKind::TEXTURE_2D;
+    Texture2D texture = LoadTexture2DFromFile(file_path, is_srgb, is_flip, info);
+    return texture2Ds.Add(texture, std::move(info));
 }
 
-Texture2D& TextureManager::CreateTexture2D(const int width, const int height, const std::string& texture_name) {
+TextureHandle TextureManager::CreateRenderTarget(const int width, const int height, const std::string& texture_name) {
     Texture2D texture = Texture2D();
     texture.Generate(GL_RGB16F, GL_RGB, width, height, nullptr, false);
     texture.SetFilterParameters(GL_LINEAR, GL_LINEAR);
     texture.SetWrapParameters(GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE);
-    texture2Ds[texture_name] = texture;
-    return texture2Ds[texture_name];
+
+    TextureInfo info;
+    info.name = texture_name;
+    info.kind = TextureKind::RENDER_TARGET;
+    info.width = width;
+    info.height = height;
+    info.internal_format = GL_RGB16F;
+    info.bytes = ImageBytes(width, height, GL_RGB16F, false);
+    return texture2Ds.Add(texture, std::move(info));
 }
 
-Texture2D &TextureManager::GetTexture2D(const std::string &texture_name) {
-    if (texture2Ds.find(texture_name) != texture2Ds.end()) {
-        return texture2Ds[texture_name];
-    } else {
+TextureHandle TextureManager::FindTexture2D(const std::string &texture_name) {
+    auto it = texture2Ds.names.find(texture_name);
+    if (it == texture2Ds.names.end()) {
         Logger::Message(LogLevel::Error, "The texture <" + texture_name + "> which is not loaded in the application.");
         Logger::Message(LogLevel::Error, "Maybe you forget to use CreateTexture2D() in the TextureManager::Initialize().");
         exit(-1);
     }
+    return it->second;
 }
 
-CubeMap& TextureManager::CreateCubeMap(const std::vector<std::string> &file_names, const std::string &texture_name, bool is_srgb) {
-    cubemaps[texture_name] = LoadCubeMapFromFile(file_names, is_srgb);
-    return cubemaps[texture_name];
+CubeMapHandle TextureManager::CreateCubeMap(const std::vector<std::string> &file_names, const std::string &texture_name, bool is_srgb) {
+    TextureInfo info;
+    info.name = texture_name;
+    info.kind = TextureKind::CUBE_MAP;
+    CubeMap cubemap = LoadCubeMapFromFile(file_names, is_srgb, info);
+    return cubemaps.Add(cubemap, std::move(info));
 }
 
-CubeMap& TextureManager::GetCubeMap(const std::string& texture_name) {
-    if (cubemaps.find(texture_name) != cubemaps.end()) {
-        return cubemaps[texture_name];
-    } else {
+CubeMapHandle TextureManager::FindCubeMap(const std::string& texture_name) {
+    auto it = cubemaps.names.find(texture_name);
+    if (it == cubemaps.names.end()) {
         Logger::Message(LogLevel::Error, "The cube maps <" + texture_name + "> which is not loaded in the application.");
         Logger::Message(LogLevel::Error, "Maybe you forget to use CreateCubeMap() in the TextureManager::Initialize().");
         exit(-1);
     }
+    return it->second;
+}
+
+Texture2D &TextureManager::GetTexture2D(TextureHandle handle) {
+    if (!texture2Ds.Contains(handle)) {
+        Logger::Message(LogLevel::Error, "Texture handle " + std::to_string(handle.index) + " (generation " + std::to_string(handle.generation) +
+                                         ") does not refer to a live texture, it was released or never created.");
+        exit(-1);
+    }
+    return texture2Ds.resources[handle.index];
+}
+
+CubeMap &TextureManager::GetCubeMap(CubeMapHandle handle) {
+    if (!cubemaps.Contains(handle)) {
+        Logger::Message(LogLevel::Error, "Cube map handle " + std::to_string(handle.index) + " (generation " + std::to_string(handle.generation) +
+                                         ") does not refer to a live cube map, it was released or never created.");
+        exit(-1);
+    }
+    return cubemaps.resources[handle.index];
 }
 
+void TextureManager::ResizeRenderTarget(TextureHandle handle, const int width, const int height) {
+    Texture2D& texture = GetTexture2D(handle);
+    TextureInfo& info = texture2Ds.infos[handle.index];
+    if (info.kind != TextureKind::RENDER_TARGET) {
+        Logger::Message(LogLevel::Error, "The texture <" + info.name + "> is not a render target and can not be resized.");
+        exit(-1);
+    }
+
+    // Generate() resets the parameters to its defaults, a render target is sampled linear and clamped.
+    texture.Bind();
+    texture.Generate(info.internal_format, GL_RGB, width, height, nullptr, false);
+    texture.UnBind();
+    texture.SetFilterParameters(GL_LINEAR, GL_LINEAR);
+    texture.SetWrapParameters(GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE);
+    info.width = width;
+    info.height = height;
+    info.bytes = ImageBytes(width, height, info.internal_format, false);
+}
+
+void TextureManager::Release(TextureHandle handle) {
+    GetTexture2D(handle).Destroy();
+    texture2Ds.Remove(handle);
+}
+
+void TextureManager::Release(CubeMapHandle handle) {
+    GetCubeMap(handle).Destroy();
+    cubemaps.Remove(handle);
+}
+
+const TextureInfo &TextureManager::GetTextureInfo(TextureHandle handle) {
+    GetTexture2D(handle);
+    return texture2Ds.infos[handle.index];
+}
+
+const std::vector<TextureInfo> &TextureManager::GetTextureInfos() {
+    return texture2Ds.infos;
+}
+
+const std::vector<TextureInfo> &TextureManager::GetCubeMapInfos() {
+    return cubemaps.infos;
+}
+
+std::size_t TextureManager::GetGPUBytes(TextureKind kind) {
+    const std::vector<TextureInfo>& infos = kind == TextureKind::CUBE_MAP ? cubemaps.infos : texture2Ds.infos;
+    std::size_t bytes = 0;
+    for (const TextureInfo& info : infos) {
+        if (info.alive && info.kind == kind) {
+            bytes += info.bytes;
+        }
+    }
+    return bytes;
+}
+
+std::size_t TextureManager::GetGPUBytes() {
+    return GetGPUBytes(TextureKind::TEXTURE_2D) + GetGPUBytes(TextureKind::RENDER_TARGET) + GetGPUBytes(TextureKind::CUBE_MAP);
+}
 
-Texture2D TextureManager::LoadTexture2DFromFile(const std::string &file_path, bool is_srgb, bool is_flip) {
+Texture2D TextureManager::LoadTexture2DFromFile(const std::string &file_path, bool is_srgb, bool is_flip, TextureInfo &info) {
     Texture2D texture;
 
     int width, height, nrChannels;
@@ -116,6 +236,10 @@ Texture2D TextureManager::LoadTexture2DFromFile(const std::string &file_path, bo
         // Create texture and binding
         texture.Generate(internal_format, format, width, height, image, true);
         stbi_image_free(image);
+        info.width = width;
+        info.height = height;
+        info.internal_format = internal_format;
+        info.bytes = ImageBytes(width, height, internal_format, true);
     } else {
         Logger::Message(LogLevel::Error, "Failed to load image at path: " + file_path);
         stbi_image_free(image);
@@ -127,7 +251,7 @@ Texture2D TextureManager::LoadTexture2DFromFile(const std::string &file_path, bo
     return texture;
 }
 
-CubeMap TextureManager::LoadCubeMapFromFile(const std::vector<std::string>& file_path, bool is_srgb) {
+CubeMap TextureManager::LoadCubeMapFromFile(const std::vector<std::string>& file_path, bool is_srgb, TextureInfo &info) {
     CubeMap cubemap;
 
     cubemap.Bind();
@@ -179,6 +303,11 @@ CubeMap TextureManager::LoadCubeMapFromFile(const std::vector<std::string>& file
             // Create texture and binding
             cubemap.BindImage(i, internal_format, format, width, height, image);
             stbi_image_free(image);
+            info.width = width;
+            info.height = height;
+            info.internal_format = internal_format;
+            // Every face has its own mipmap chain
+            info.bytes += ImageBytes(width, height, internal_format, true);
         } else {
             Logger::Message(LogLevel::Error, "Failed to load image at path: " + file_path[i]);
             stbi_image_free(image);
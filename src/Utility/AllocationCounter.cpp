@@ -0,0 +1,117 @@
+#include "Utility/AllocationCounter.hpp"
+
+#ifdef VOLUME_RENDERER_COUNT_ALLOCATIONS
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+    std::atomic<std::uint64_t> allocation_count { 0 };
+    std::atomic<std::uint64_t> allocation_bytes { 0 };
+
+    AllocationCounter::Totals frame_begin;
+    AllocationCounter::Totals last_frame;
+    std::uint64_t allocating_frames = 0;
+
+    void* Allocate(std::size_t size) {
+        allocation_count.fetch_add(1, std::memory_order_relaxed);
+        allocation_bytes.fetch_add(size, std::memory_order_relaxed);
+        return std::malloc(size == 0 ? 1 : size);
+    }
+}
+
+// The aligned overloads are left to the standard library, nothing in the render loop over-aligns.
+void* operator new(std::size_t size) {
+    if (void* pointer = Allocate(size)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    if (void* pointer = Allocate(size)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return Allocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return Allocate(size);
+}
+
+void operator delete(void* pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, const std::nothrow_t&) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept {
+    std::free(pointer);
+}
+
+bool AllocationCounter::IsEnabled() {
+    return true;
+}
+
+AllocationCounter::Totals AllocationCounter::Current() {
+    return { allocation_count.load(std::memory_order_relaxed), allocation_bytes.load(std::memory_order_relaxed) };
+}
+
+void AllocationCounter::EndFrame() {
+    const Totals now = Current();
+    last_frame = now - frame_begin;
+    frame_begin = now;
+    if (last_frame.count > 0) {
+        allocating_frames++;
+    }
+}
+
+AllocationCounter::Totals AllocationCounter::LastFrame() {
+    return last_frame;
+}
+
+std::uint64_t AllocationCounter::AllocatingFrames() {
+    return allocating_frames;
+}
+
+#else
+
+bool AllocationCounter::IsEnabled() {
+    return false;
+}
+
+AllocationCounter::Totals AllocationCounter::Current() {
+    return {};
+}
+
+void AllocationCounter::EndFrame() {
+}
+
+AllocationCounter::Totals AllocationCounter::LastFrame() {
+    return {};
+}
+
+std::uint64_t AllocationCounter::AllocatingFrames() {
+    return 0;
+}
+
+#endif
@@ -0,0 +1,100 @@
+#include "Utility/FrameStatistics.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#include "Utility/Logger.hpp"
+
+FrameStatistics::FrameStatistics(std::vector<std::string> columns) : m_columns(std::move(columns)) {
+
+}
+
+void FrameStatistics::AddFrame(const std::vector<double>& values) {
+    m_frames.push_back(values);
+    m_frames.back().resize(m_columns.size(), 0.0);
+}
+
+std::size_t FrameStatistics::FrameCount() const {
+    return m_frames.size();
+}
+
+double FrameStatistics::Percentile(std::size_t column, double p) const {
+    if (m_frames.empty()) {
+        return 0.0;
+    }
+
+    std::vector<double> values;
+    values.reserve(m_frames.size());
+    for (const auto& frame : m_frames) {
+        values.push_back(frame[column]);
+    }
+    std::sort(values.begin(), values.end());
+
+    const double rank = std::ceil(p / 100.0 * static_cast<double>(values.size()));
+    const std::size_t index = static_cast<std::size_t>(std::clamp(rank, 1.0, static_cast<double>(values.size()))) - 1;
+    return values[index];
+}
+
+double FrameStatistics::Mean(std::size_t column) const {
+    if (m_frames.empty()) {
+        return 0.0;
+    }
+
+    double sum = 0.0;
+    for (const auto& frame : m_frames) {
+        sum += frame[column];
+    }
+    return sum / static_cast<double>(m_frames.size());
+}
+
+bool FrameStatistics::WriteCSV(const std::string& file_path) const {
+    std::ofstream file(file_path);
+    if (file.fail()) {
+        Logger::Message(LogLevel::Error, "Failed to write the frame statistics, file path: " + file_path);
+        return false;
+    }
+
+    file << std::fixed << std::setprecision(4);
+    file << "frame";
+    for (const auto& column : m_columns) {
+        file << "," << column;
+    }
+    file << "\n";
+    for (std::size_t n = 0; n < m_frames.size(); n++) {
+        file << n;
+        for (const double value : m_frames[n]) {
+            file << "," << value;
+        }
+        file << "\n";
+    }
+
+    std::filesystem::path summary_path = file_path;
+    summary_path.replace_filename(summary_path.stem().string() + "_summary.csv");
+    std::ofstream summary(summary_path);
+    if (summary.fail()) {
+        Logger::Message(LogLevel::Error, "Failed to write the frame statistics summary, file path: " + summary_path.string());
+        return false;
+    }
+
+    summary << std::fixed << std::setprecision(4);
+    summary << "column,mean,p50,p95,p99\n";
+    for (std::size_t column = 0; column < m_columns.size(); column++) {
+        summary << m_columns[column] << "," << Mean(column) << "," << Percentile(column, 50.0) << ","
+                << Percentile(column, 95.0) << "," << Percentile(column, 99.0) << "\n";
+    }
+    return true;
+}
+
+void FrameStatistics::LogSummary() const {
+    Logger::Message(LogLevel::Info, "Frames: " + std::to_string(m_frames.size()) + " (milliseconds: mean / p50 / p95 / p99)");
+    for (std::size_t column = 0; column < m_columns.size(); column++) {
+        std::ostringstream line;
+        line << std::fixed << std::setprecision(3) << m_columns[column] << ": " << Mean(column) << " / "
+             << Percentile(column, 50.0) << " / " << Percentile(column, 95.0) << " / " << Percentile(column, 99.0);
+        Logger::Message(LogLevel::Info, line.str());
+    }
+}
@@ -0,0 +1,126 @@
+#include "Utility/MemoryMappedFile.hpp"
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "Utility/Logger.hpp"
+
+#if defined(_WIN32)
+
+MemoryMappedFile::MemoryMappedFile(const std::string& file_path) :
+    m_data(nullptr), m_size(0), m_file_handle(INVALID_HANDLE_VALUE), m_mapping_handle(nullptr) {
+    m_file_handle = CreateFileA(file_path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (m_file_handle == INVALID_HANDLE_VALUE) {
+        Logger::Message(LogLevel::Warning, "Failed to open the file for memory mapping: " + file_path);
+        return;
+    }
+
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(m_file_handle, &file_size) || file_size.QuadPart == 0) {
+        Close();
+        return;
+    }
+    m_size = static_cast<std::size_t>(file_size.QuadPart);
+
+    m_mapping_handle = CreateFileMappingA(m_file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (m_mapping_handle == nullptr) {
+        Logger::Message(LogLevel::Warning, "Failed to create the file mapping: " + file_path);
+        Close();
+        return;
+    }
+
+    m_data = static_cast<const unsigned char*>(MapViewOfFile(m_mapping_handle, FILE_MAP_READ, 0, 0, 0));
+    if (m_data == nullptr) {
+        Logger::Message(LogLevel::Warning, "Failed to map the view of file: " + file_path);
+        Close();
+    }
+}
+
+void MemoryMappedFile::Close() {
+    if (m_data != nullptr) {
+        UnmapViewOfFile(m_data);
+        m_data = nullptr;
+    }
+    if (m_mapping_handle != nullptr) {
+        CloseHandle(m_mapping_handle);
+        m_mapping_handle = nullptr;
+    }
+    if (m_file_handle != INVALID_HANDLE_VALUE) {
+        CloseHandle(m_file_handle);
+        m_file_handle = INVALID_HANDLE_VALUE;
+    }
+    m_size = 0;
+}
+
+#else
+
+MemoryMappedFile::MemoryMappedFile(const std::string& file_path) :
+    m_data(nullptr), m_size(0), m_file_descriptor(-1) {
+    m_file_descriptor = open(file_path.c_str(), O_RDONLY);
+    if (m_file_descriptor == -1) {
+        Logger::Message(LogLevel::Warning, "Failed to open the file for memory mapping: " + file_path);
+        return;
+    }
+
+    struct stat file_stat {};
+    if (fstat(m_file_descriptor, &file_stat) == -1 || file_stat.st_size == 0) {
+        Close();
+        return;
+    }
+    m_size = static_cast<std::size_t>(file_stat.st_size);
+
+    void* address = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, m_file_descriptor, 0);
+    if (address == MAP_FAILED) {
+        Logger::Message(LogLevel::Warning, "Failed to map the file: " + file_path);
+        Close();
+        return;
+    }
+    m_data = static_cast<const unsigned char*>(address);
+
+    // 讀取 volume 時是從頭到尾掃過一次，提示 kernel 可以積極地預讀
+    madvise(address, m_size, MADV_SEQUENTIAL);
+    madvise(address, m_size, MADV_WILLNEED);
+}
+
+void MemoryMappedFile::Close() {
+    if (m_data != nullptr) {
+        munmap(const_cast<unsigned char*>(m_data), m_size);
+        m_data = nullptr;
+    }
+    if (m_file_descriptor != -1) {
+        close(m_file_descriptor);
+        m_file_descriptor = -1;
+    }
+    m_size = 0;
+}
+
+#endif
+
+MemoryMappedFile::~MemoryMappedFile() {
+    Close();
+}
+
+bool MemoryMappedFile::IsOpen() const {
+    return m_data != nullptr;
+}
+
+const unsigned char* MemoryMappedFile::Data() const {
+    return m_data;
+}
+
+std::size_t MemoryMappedFile::Size() const {
+    return m_size;
+}
@@ -0,0 +1,56 @@
+#include "Utility/MemoryUsage.hpp"
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#include <cstdio>
+
+std::size_t MemoryUsage::PeakResidentBytes() {
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters {};
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return static_cast<std::size_t>(counters.PeakWorkingSetSize);
+    }
+    return 0;
+#else
+    struct rusage usage {};
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+#if defined(__APPLE__)
+    // macOS reports ru_maxrss in bytes
+    return static_cast<std::size_t>(usage.ru_maxrss);
+#else
+    // Linux reports ru_maxrss in kilobytes
+    return static_cast<std::size_t>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
+
+std::string MemoryUsage::FormatBytes(std::size_t bytes) {
+    char buffer[32];
+    FormatBytes(bytes, buffer, sizeof(buffer));
+    return buffer;
+}
+
+void MemoryUsage::FormatBytes(std::size_t bytes, char* buffer, std::size_t buffer_size) {
+    const char* units[] = { "B", "KB", "MB", "GB", "TB" };
+    auto value = static_cast<double>(bytes);
+    int unit = 0;
+    while (value >= 1024.0 && unit < 4) {
+        value /= 1024.0;
+        unit++;
+    }
+
+    std::snprintf(buffer, buffer_size, "%.*f %s", unit == 0 ? 0 : 2, value, units[unit]);
+}
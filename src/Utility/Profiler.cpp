@@ -0,0 +1,236 @@
+#include "Utility/Profiler.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <string_view>
+#include <utility>
+
+#include "Utility/Logger.hpp"
+
+namespace {
+    void WriteEscaped(std::ofstream& file, const char* text) {
+        for (const char* c = text; *c != '\0'; c++) {
+            if (*c == '"' || *c == '\\') {
+                file << '\\';
+            }
+            file << *c;
+        }
+    }
+
+    // Follows the thread name metadata, so every event starts with a comma.
+    void WriteEvent(std::ofstream& file, const char* name, const char* category, int thread, double begin_ms, double duration_ms, long long frame) {
+        file << ",\n{\"name\":\"";
+        WriteEscaped(file, name);
+        // Microseconds
+        file << "\",\"cat\":\"" << category << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << thread
+             << ",\"ts\":" << begin_ms * 1000.0 << ",\"dur\":" << duration_ms * 1000.0
+             << ",\"args\":{\"frame\":" << frame << "}}";
+    }
+}
+
+Profiler& Profiler::Shared() {
+    static Profiler profiler;
+    return profiler;
+}
+
+Profiler::Profiler() : m_origin(std::chrono::steady_clock::now()), m_history(HistorySize) {
+    m_open.reserve(16);
+}
+
+void Profiler::BeginFrame() {
+    m_slot = static_cast<int>(m_frame_index % FramesInFlight);
+
+    // The frame which used these queries FramesInFlight frames ago, the GPU is usually done with it by now.
+    if (m_has_pending[m_slot]) {
+        Frame& frame = m_pending[m_slot];
+        for (Sample& sample : frame.samples) {
+            if (sample.query < 0) {
+                continue;
+            }
+            // Reading a result which is not there yet would wait for the GPU, the scope is left untimed instead.
+            const GLuint query = m_queries[m_slot][sample.query];
+            GLint available = GL_FALSE;
+            glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+            if (available == GL_FALSE) {
+                continue;
+            }
+            GLuint64 nanoseconds = 0;
+            glGetQueryObjectui64v(query, GL_QUERY_RESULT, &nanoseconds);
+            sample.gpu_ms = static_cast<double>(nanoseconds) / 1.0e6;
+            frame.gpu_ms += sample.gpu_ms;
+        }
+
+        // Reuse the storage of the oldest frame for the next one.
+        std::swap(m_history[(m_history_begin + m_history_count) % HistorySize], frame);
+        if (m_history_count < HistorySize) {
+            m_history_count++;
+        } else {
+            m_history_begin = (m_history_begin + 1) % HistorySize;
+        }
+        m_has_pending[m_slot] = false;
+    }
+
+    m_recording = enabled;
+    if (!m_recording) {
+        m_frame_index++;
+        return;
+    }
+
+    Frame& frame = m_pending[m_slot];
+    frame.index = m_frame_index++;
+    frame.begin_ms = Now();
+    frame.cpu_ms = 0.0;
+    frame.gpu_ms = 0.0;
+    frame.samples.clear();
+    m_used_queries[m_slot] = 0;
+    m_gpu_owner = -1;
+    m_open.clear();
+}
+
+void Profiler::EndFrame() {
+    if (!m_recording) {
+        return;
+    }
+    while (!m_open.empty()) {
+        End();
+    }
+
+    Frame& frame = m_pending[m_slot];
+    frame.cpu_ms = Now() - frame.begin_ms;
+    m_has_pending[m_slot] = true;
+    m_recording = false;
+}
+
+void Profiler::Begin(const char* name, bool gpu) {
+    if (!m_recording) {
+        return;
+    }
+
+    Frame& frame = m_pending[m_slot];
+    Sample sample { name, static_cast<int>(m_open.size()), Now() - frame.begin_ms, 0.0, -1.0, -1 };
+    if (gpu && m_gpu_owner < 0) {
+        std::vector<GLuint>& queries = m_queries[m_slot];
+        if (m_used_queries[m_slot] == queries.size()) {
+            GLuint query = 0;
+            glGenQueries(1, &query);
+            queries.push_back(query);
+        }
+        sample.query = static_cast<int>(m_used_queries[m_slot]++);
+        glBeginQuery(GL_TIME_ELAPSED, queries[sample.query]);
+        m_gpu_owner = static_cast<int>(frame.samples.size());
+    }
+
+    m_open.push_back(static_cast<int>(frame.samples.size()));
+    frame.samples.push_back(sample);
+}
+
+void Profiler::End() {
+    if (!m_recording || m_open.empty()) {
+        return;
+    }
+
+    Frame& frame = m_pending[m_slot];
+    const int index = m_open.back();
+    m_open.pop_back();
+
+    Sample& sample = frame.samples[index];
+    sample.cpu_ms = Now() - frame.begin_ms - sample.cpu_begin_ms;
+    if (index == m_gpu_owner) {
+        glEndQuery(GL_TIME_ELAPSED);
+        m_gpu_owner = -1;
+    }
+}
+
+std::size_t Profiler::FrameCount() const {
+    return m_history_count;
+}
+
+const Profiler::Frame& Profiler::GetFrame(std::size_t index) const {
+    return m_history[(m_history_begin + index) % HistorySize];
+}
+
+void Profiler::Averages(std::vector<Average>& averages) const {
+    averages.clear();
+    for (std::size_t i = 0; i < m_history_count; i++) {
+        const Frame& frame = GetFrame(i);
+        for (const Sample& sample : frame.samples) {
+            auto it = averages.begin();
+            for (; it != averages.end(); it++) {
+                if (it->depth == sample.depth && std::string_view(it->name) == sample.name) {
+                    break;
+                }
+            }
+            if (it == averages.end()) {
+                averages.push_back({ sample.name, sample.depth, 0.0, 0.0, 0, 0 });
+                it = averages.end() - 1;
+            }
+
+            it->cpu_ms += sample.cpu_ms;
+            it->count++;
+            if (sample.gpu_ms >= 0.0) {
+                it->gpu_ms += sample.gpu_ms;
+                it->gpu_count++;
+            }
+        }
+    }
+
+    // Per frame in which the scope ran
+    for (Average& average : averages) {
+        average.cpu_ms /= average.count;
+        average.gpu_ms = average.gpu_count > 0 ? average.gpu_ms / average.gpu_count : -1.0;
+    }
+}
+
+void Profiler::Clear() {
+    m_history_begin = 0;
+    m_history_count = 0;
+}
+
+bool Profiler::WriteChromeTrace(const std::string& file_path) const {
+    std::ofstream file(file_path);
+    if (file.fail()) {
+        Logger::Message(LogLevel::Error, "Failed to write the trace: " + file_path);
+        return false;
+    }
+
+    file << "{\"traceEvents\":[";
+    file << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"CPU\"}},"
+         << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,\"args\":{\"name\":\"GPU\"}}";
+
+    for (std::size_t i = 0; i < m_history_count; i++) {
+        const Frame& frame = GetFrame(i);
+        WriteEvent(file, "Frame", "cpu", 1, frame.begin_ms, frame.cpu_ms, frame.index);
+
+        // GL_TIME_ELAPSED gives durations only: every GPU scope starts when it was submitted or when the previous one ended.
+        double gpu_end = frame.begin_ms;
+        for (const Sample& sample : frame.samples) {
+            const double begin = frame.begin_ms + sample.cpu_begin_ms;
+            WriteEvent(file, sample.name, "cpu", 1, begin, sample.cpu_ms, frame.index);
+            if (sample.gpu_ms >= 0.0) {
+                const double gpu_begin = std::max(begin, gpu_end);
+                WriteEvent(file, sample.name, "gpu", 2, gpu_begin, sample.gpu_ms, frame.index);
+                gpu_end = gpu_begin + sample.gpu_ms;
+            }
+        }
+    }
+    file << "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+    Logger::Message(LogLevel::Info, "Trace of " + std::to_string(m_history_count) + " frames written to " + file_path);
+    return true;
+}
+
+void Profiler::Destroy() {
+    for (int slot = 0; slot < FramesInFlight; slot++) {
+        if (!m_queries[slot].empty()) {
+            glDeleteQueries(static_cast<GLsizei>(m_queries[slot].size()), m_queries[slot].data());
+        }
+        m_queries[slot].clear();
+        m_has_pending[slot] = false;
+    }
+    m_recording = false;
+}
+
+double Profiler::Now() const {
+    const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - m_origin;
+    return elapsed.count();
+}
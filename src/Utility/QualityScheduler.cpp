@@ -0,0 +1,68 @@
+#include "Utility/QualityScheduler.hpp"
+
+void QualityScheduler::Invalidate() {
+    m_changed = true;
+}
+
+void QualityScheduler::ObserveCamera(const glm::mat4& view) {
+    if (!m_has_view || view != m_last_view) {
+        m_changed = m_has_view;
+        m_last_view = view;
+        m_has_view = true;
+    }
+}
+
+void QualityScheduler::Update(float frame_time) {
+    if (m_changed) {
+        // Only frames rendered at the interaction level tell how cheap it is.
+        if (m_idle_frames == 0 && m_level == m_interaction_level) {
+            if (frame_time > target_frame_time && m_interaction_level < MaxLevel) {
+                m_interaction_level++;
+            } else if (frame_time < target_frame_time * 0.5f && m_interaction_level > 0) {
+                m_interaction_level--;
+            }
+        }
+        m_level = m_interaction_level;
+        m_idle_frames = 0;
+        m_changed = false;
+        return;
+    }
+
+    m_idle_frames++;
+    if (m_idle_frames >= refine_delay && m_level > 0) {
+        m_level--;
+    }
+}
+
+int QualityScheduler::Level() const {
+    return enabled ? m_level : 0;
+}
+
+int QualityScheduler::Divisor() const {
+    return 1 << Level();
+}
+
+float QualityScheduler::StepScale() const {
+    return static_cast<float>(1 + Level());
+}
+
+bool QualityScheduler::IsInteracting() const {
+    return enabled && m_idle_frames < refine_delay;
+}
+
+bool QualityScheduler::IsRefining() const {
+    return Level() > 0;
+}
+
+const char* QualityScheduler::ShowLevel() const {
+    switch (Level()) {
+        case 0:
+            return "Full";
+        case 1:
+            return "1/2";
+        case 2:
+            return "1/4";
+        default:
+            return "";
+    }
+}
@@ -0,0 +1,132 @@
+#include "Utility/ThreadPool.hpp"
+
+#include <algorithm>
+
+ThreadPool::ThreadPool(unsigned int thread_count) {
+    Resize(thread_count);
+}
+
+ThreadPool::~ThreadPool() {
+    std::lock_guard<std::mutex> lock(m_workers_mutex);
+    StopWorkers();
+}
+
+void ThreadPool::Resize(unsigned int thread_count) {
+    if (thread_count == 0) {
+        thread_count = HardwareThreads();
+    }
+
+    // A job in flight is never lost: its caller keeps running the remaining chunks by itself.
+    std::lock_guard<std::mutex> lock(m_workers_mutex);
+    StopWorkers();
+    StartWorkers(thread_count - 1);
+}
+
+unsigned int ThreadPool::Size() const {
+    return m_worker_count.load() + 1;
+}
+
+void ThreadPool::ParallelFor(int begin, int end, int grain, const std::function<void(int, int)>& body) {
+    if (begin >= end) {
+        return;
+    }
+    grain = std::max(grain, 1);
+
+    auto job = std::make_shared<Job>();
+    job->body = body;
+    job->begin = begin;
+    job->end = end;
+    job->grain = grain;
+    job->chunk_count = (end - begin + grain - 1) / grain;
+    job->remaining_chunks = job->chunk_count;
+
+    if (job->chunk_count > 1 && m_worker_count.load() > 0) {
+        std::lock_guard<std::mutex> lock(m_jobs_mutex);
+        m_jobs.push_back(job);
+        m_jobs_condition.notify_all();
+    }
+
+    // The caller works on its own job as well.
+    RunChunks(job);
+
+    std::unique_lock<std::mutex> lock(job->done_mutex);
+    job->done_condition.wait(lock, [&job]() { return job->remaining_chunks.load() == 0; });
+}
+
+ThreadPool& ThreadPool::Shared() {
+    static ThreadPool pool;
+    return pool;
+}
+
+unsigned int ThreadPool::HardwareThreads() {
+    return std::max(std::thread::hardware_concurrency(), 1u);
+}
+
+void ThreadPool::StartWorkers(unsigned int worker_count) {
+    {
+        std::lock_guard<std::mutex> lock(m_jobs_mutex);
+        m_stop = false;
+    }
+    for (unsigned int i = 0; i < worker_count; i++) {
+        m_workers.emplace_back(&ThreadPool::WorkerLoop, this);
+    }
+    m_worker_count = worker_count;
+}
+
+void ThreadPool::StopWorkers() {
+    m_worker_count = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_jobs_mutex);
+        m_stop = true;
+        m_jobs_condition.notify_all();
+    }
+    for (auto& worker : m_workers) {
+        worker.join();
+    }
+    m_workers.clear();
+}
+
+void ThreadPool::WorkerLoop() {
+    while (true) {
+        std::shared_ptr<Job> job = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(m_jobs_mutex);
+            m_jobs_condition.wait(lock, [this]() { return m_stop || !m_jobs.empty(); });
+            if (m_stop) {
+                return;
+            }
+            job = m_jobs.front();
+        }
+
+        RunChunks(job);
+    }
+}
+
+void ThreadPool::RunChunks(const std::shared_ptr<Job>& job) {
+    while (true) {
+        const int chunk = job->next_chunk.fetch_add(1);
+        if (chunk >= job->chunk_count) {
+            break;
+        }
+
+        const int chunk_begin = job->begin + chunk * job->grain;
+        const int chunk_end = std::min(chunk_begin + job->grain, job->end);
+        job->body(chunk_begin, chunk_end);
+
+        if (job->remaining_chunks.fetch_sub(1) == 1) {
+            std::lock_guard<std::mutex> lock(job->done_mutex);
+            job->done_condition.notify_all();
+        }
+    }
+
+    // Every chunk is taken, do not hand this job to other workers anymore.
+    RemoveJob(job);
+}
+
+void ThreadPool::RemoveJob(const std::shared_ptr<Job>& job) {
+    std::lock_guard<std::mutex> lock(m_jobs_mutex);
+    auto it = std::find(m_jobs.begin(), m_jobs.end(), job);
+    if (it != m_jobs.end()) {
+        m_jobs.erase(it);
+    }
+}
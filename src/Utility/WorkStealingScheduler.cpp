@@ -0,0 +1,82 @@
+#include "Utility/WorkStealingScheduler.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace {
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<int> tasks;
+
+        bool PopFront(int& task) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (tasks.empty()) {
+                return false;
+            }
+            task = tasks.front();
+            tasks.pop_front();
+            return true;
+        }
+
+        bool PopBack(int& task) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (tasks.empty()) {
+                return false;
+            }
+            task = tasks.back();
+            tasks.pop_back();
+            return true;
+        }
+    };
+}
+
+WorkStealingScheduler::Statistics WorkStealingScheduler::Run(ThreadPool& pool, int count, const std::function<void(int, int)>& task) {
+    Statistics statistics;
+    statistics.tasks = static_cast<std::size_t>(std::max(count, 0));
+    if (count <= 0) {
+        return statistics;
+    }
+
+    // Contiguous blocks of tasks per worker
+    const int worker_count = static_cast<int>(std::min<unsigned int>(pool.Size(), static_cast<unsigned int>(count)));
+    std::vector<std::unique_ptr<WorkerQueue>> queues(worker_count);
+    for (int w = 0; w < worker_count; w++) {
+        queues[w] = std::make_unique<WorkerQueue>();
+        const int begin = static_cast<int>(static_cast<long long>(count) * w / worker_count);
+        const int end = static_cast<int>(static_cast<long long>(count) * (w + 1) / worker_count);
+        for (int n = begin; n < end; n++) {
+            queues[w]->tasks.push_back(n);
+        }
+    }
+
+    std::atomic<std::size_t> steals { 0 };
+    pool.ParallelFor(0, worker_count, 1, [&](int worker_begin, int worker_end) {
+        for (int worker = worker_begin; worker < worker_end; worker++) {
+            int index = 0;
+            while (true) {
+                if (queues[worker]->PopFront(index)) {
+                    task(index, worker);
+                    continue;
+                }
+
+                // Steal from the back of the others, starting with the next worker.
+                bool stolen = false;
+                for (int offset = 1; offset < worker_count && !stolen; offset++) {
+                    stolen = queues[(worker + offset) % worker_count]->PopBack(index);
+                }
+                if (!stolen) {
+                    break;
+                }
+                steals.fetch_add(1, std::memory_order_relaxed);
+                task(index, worker);
+            }
+        }
+    });
+
+    statistics.steals = steals.load();
+    return statistics;
+}
@@ -0,0 +1,76 @@
+#include "World/SceneSnapshot.hpp"
+
+#include <tuple>
+
+SceneSnapshot SceneSnapshot::Capture(const World& world, const TransferFunctionWidget& transfer_function) {
+    SceneSnapshot snapshot {};
+
+    const Camera& camera = *world.my_camera;
+    snapshot.view = camera.View();
+    snapshot.zoom = camera.zoom;
+    snapshot.is_perspective = camera.is_perspective;
+    snapshot.viewport_width = camera.viewport.width;
+    snapshot.viewport_height = camera.viewport.height;
+
+    const Light& light = *world.my_point_light;
+    snapshot.light_position = light.entity.position;
+    snapshot.light_color = light.color;
+    snapshot.light_enable = light.enable;
+
+    snapshot.volume = world.my_volume.get();
+    snapshot.transfer_function_version = transfer_function.GetVersion();
+
+    snapshot.draw_axes = world.draw_axes;
+    snapshot.culling = world.culling;
+    snapshot.use_empty_space_skipping = world.use_empty_space_skipping;
+    snapshot.use_slab_ray_setup = world.use_slab_ray_setup;
+    snapshot.use_preintegration = world.use_preintegration;
+    snapshot.use_opacity_correction = world.use_opacity_correction;
+    snapshot.use_adaptive_sampling = world.use_adaptive_sampling;
+    snapshot.use_lighting = world.use_lighting;
+    snapshot.use_normal_color = world.use_normal_color;
+    snapshot.use_bloom = world.use_bloom;
+    snapshot.use_ray_statistics = world.use_ray_statistics;
+    snapshot.opacity_reference_step = world.opacity_reference_step;
+    snapshot.adaptive_max_step_scale = world.adaptive_max_step_scale;
+    snapshot.adaptive_importance_threshold = world.adaptive_importance_threshold;
+    snapshot.sample_rate = world.sample_rate;
+    snapshot.bloom_threshold = world.bloom_threshold;
+    snapshot.bloom_strength = world.bloom_strength;
+    snapshot.bloom_method = world.current_bloom_method;
+    snapshot.bloom_mip_levels = world.bloom_mip_levels;
+    snapshot.bloom_filter_radius = world.bloom_filter_radius;
+    snapshot.quality_level = world.quality.Level();
+    snapshot.background_color = world.background_color;
+
+    snapshot.screen_mode = world.current_screen_mode;
+    snapshot.bloom_intensity = world.bloom_intensity;
+    snapshot.use_gamma_correction = world.use_gamma_correction;
+    snapshot.gamma_value = world.gamma_value;
+    snapshot.use_hdr = world.use_hdr;
+    snapshot.hdr_mode = world.current_hdr_mode;
+    snapshot.hdr_exposure = world.hdr_exposure;
+    return snapshot;
+}
+
+bool SceneSnapshot::SceneDiffers(const SceneSnapshot& other) const {
+    const auto scene = [](const SceneSnapshot& s) {
+        return std::tie(s.view, s.zoom, s.is_perspective, s.viewport_width, s.viewport_height,
+                        s.light_position, s.light_color, s.light_enable,
+                        s.volume, s.transfer_function_version,
+                        s.draw_axes, s.culling, s.use_empty_space_skipping, s.use_slab_ray_setup, s.use_preintegration, s.use_opacity_correction,
+                        s.use_adaptive_sampling, s.use_lighting, s.use_normal_color, s.use_bloom, s.use_ray_statistics,
+                        s.opacity_reference_step, s.adaptive_max_step_scale, s.adaptive_importance_threshold,
+                        s.sample_rate, s.bloom_threshold, s.bloom_strength,
+                        s.bloom_method, s.bloom_mip_levels, s.bloom_filter_radius, s.quality_level, s.background_color);
+    };
+    return scene(*this) != scene(other);
+}
+
+bool SceneSnapshot::ScreenDiffers(const SceneSnapshot& other) const {
+    const auto screen = [](const SceneSnapshot& s) {
+        return std::tie(s.screen_mode, s.bloom_intensity, s.use_gamma_correction, s.gamma_value,
+                        s.use_hdr, s.hdr_mode, s.hdr_exposure);
+    };
+    return screen(*this) != screen(other);
+}
@@ -39,6 +39,7 @@ void World::Create() {
 }
 
 void World::Destroy() {
+    volume_loader.Shutdown();
     TextureManager::Destroy();
 }
 
@@ -1,14 +1,82 @@
+#include <algorithm>
+#include <cstdlib>
 #include <memory>
+#include <string>
 
 #include "Config.hpp"
 #include "Application.hpp"
+#include "Maths/GradientBenchmark.hpp"
+#include "Renderer/CpuRenderBenchmark.hpp"
+#include "Utility/Logger.hpp"
 
 #include "State.hpp"
 
 State state;
 
+/**
+ * Usage:
+ *   volume_renderer [--no-vsync] [--no-shader-cache] [--gaussian-bloom] [--legacy-ray-setup]
+ *   volume_renderer --gradient-benchmark <volume.toml>
+ *   volume_renderer --benchmark [--volume <volume.toml>] [--tf <preset.toml>] [--frames N] [--warmup N]
+ *                   [--output <file.csv>] [--width W] [--height H] [--gaussian-bloom] [--legacy-ray-setup]
+ *   volume_renderer --cpu-render [--volume <volume.toml>] [--tf <preset.toml>] [--image <file.png>]
+ *                   [--width W] [--height H] [--scaling]
+ */
+static void ParseArguments(int argc, char **argv, Config& config) {
+    for (int i = 1; i < argc; i++) {
+        const std::string argument = argv[i];
+        const bool has_value = i + 1 < argc;
+
+        if (argument == "--benchmark") {
+            config.benchmark = true;
+            config.vsync = false;
+        } else if (argument == "--cpu-render") {
+            config.cpu_render = true;
+        } else if (argument == "--scaling") {
+            config.cpu_render_scaling = true;
+        } else if (argument == "--image" && has_value) {
+            config.cpu_render_image = argv[++i];
+        } else if (argument == "--volume" && has_value) {
+            config.benchmark_volume = argv[++i];
+        } else if (argument == "--tf" && has_value) {
+            config.benchmark_transfer_function = argv[++i];
+        } else if (argument == "--frames" && has_value) {
+            config.benchmark_frames = std::max(1, std::atoi(argv[++i]));
+        } else if (argument == "--warmup" && has_value) {
+            config.benchmark_warmup_frames = std::max(0, std::atoi(argv[++i]));
+        } else if (argument == "--output" && has_value) {
+            config.benchmark_output = argv[++i];
+        } else if (argument == "--width" && has_value) {
+            config.width = std::max(1, std::atoi(argv[++i]));
+        } else if (argument == "--height" && has_value) {
+            config.height = std::max(1, std::atoi(argv[++i]));
+        } else if (argument == "--no-shader-cache") {
+            config.shader_cache_directory.clear();
+        } else if (argument == "--gaussian-bloom") {
+            config.gaussian_bloom = true;
+        } else if (argument == "--legacy-ray-setup") {
+            config.legacy_ray_setup = true;
+        } else if (argument == "--no-vsync") {
+            config.vsync = false;
+        } else {
+            Logger::Message(LogLevel::Warning, "Unknown argument: " + argument);
+        }
+    }
+}
+
 int main(int argc, char **argv) {
+    // Gradient kernel validation and benchmark, no window is created
+    if (argc >= 3 && std::string(argv[1]) == "--gradient-benchmark") {
+        return Maths::GradientBenchmark::Run(argv[2]);
+    }
+
     std::unique_ptr<Config> config = std::make_unique<Config>();
+    ParseArguments(argc, argv, *config);
+
+    // Software rendering, no window is created
+    if (config->cpu_render) {
+        return CpuRenderBenchmark::Run(*config);
+    }
 
     Application app(*config);
     app.Run();